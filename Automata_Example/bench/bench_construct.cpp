@@ -0,0 +1,106 @@
+#include "automaton.h"
+#include "automaton_io.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+template <typename F>
+double Seconds(F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t num_states = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 10000;
+    const size_t batch_states = 16;
+
+    std::mt19937 rng(3);
+    map<char, int> alphabet;
+    for (char c = 'a'; c <= 'p'; c++) {
+        alphabet[c] = c - 'a';
+    }
+    std::uniform_int_distribution<int> pick_state(0, static_cast<int>(num_states) - 1);
+    vector<vector<int>> M(num_states, vector<int>(alphabet.size()));
+    for (auto& row : M) {
+        for (auto& target : row) {
+            target = pick_state(rng);
+        }
+    }
+    vector<int> accepting;
+    for (size_t i = 0; i < num_states; i += 2) {
+        accepting.push_back(static_cast<int>(i));
+    }
+
+    std::ostringstream image;
+    SaveAutomatonBinary(image, Automaton(alphabet, M, accepting));
+    string bytes = image.str();
+
+    double full = Seconds([&] { Automaton dfa(alphabet, M, accepting); });
+    double trusted = Seconds([&] { Automaton dfa(alphabet, M, accepting, Validation::Trusted); });
+    double binary = Seconds([&] {
+        std::istringstream in(bytes);
+        Automaton dfa = LoadAutomatonBinary(in);
+    });
+
+    // Many small automata, built and dropped as a batch: from a map and nested
+    // vectors on the heap, and from flat arrays into one arena
+    vector<int> small_flat(batch_states * alphabet.size());
+    for (auto& target : small_flat) {
+        target = static_cast<int>(rng() % batch_states);
+    }
+    vector<int> small_accepting{0, 3, 5};
+    double batch_heap = Seconds([&] {
+        vector<Automaton> batch;
+        batch.reserve(batch_size);
+        for (size_t i = 0; i < batch_size; i++) {
+            vector<vector<int>> small(batch_states);
+            for (size_t s = 0; s < batch_states; s++) {
+                small[s].assign(small_flat.begin() + static_cast<std::ptrdiff_t>(s * alphabet.size()),
+                                small_flat.begin() + static_cast<std::ptrdiff_t>((s + 1) * alphabet.size()));
+            }
+            batch.emplace_back(alphabet, std::move(small), small_accepting);
+        }
+    });
+    double batch_arena = Seconds([&] {
+        ByteClasses classes = ByteClasses::FromMap(alphabet);
+        const size_t bytes = batch_size * Automaton::ArenaBytes(batch_states, alphabet.size());
+        std::unique_ptr<char[]> buffer(new char[bytes]);
+        std::pmr::monotonic_buffer_resource arena(buffer.get(), bytes);
+        TablePlacement placement;
+        placement.arena = &arena;
+        std::pmr::vector<Automaton> batch(&arena);
+        batch.reserve(batch_size);
+        for (size_t i = 0; i < batch_size; i++) {
+            batch.emplace_back(classes, batch_states, small_flat.data(), small_accepting.data(),
+                               small_accepting.size(), Validation::Full, placement);
+        }
+    });
+
+    std::printf("states=%zu symbols=%zu\n", num_states, alphabet.size());
+    std::printf("%-26s %8.3f s\n", "construct (validated)", full);
+    std::printf("%-26s %8.3f s\n", "construct (trusted)", trusted);
+    std::printf("%-26s %8.3f s\n", "load binary image", binary);
+    std::printf("%zu automata of %zu states:\n", batch_size, batch_states);
+    std::printf("%-26s %8.3f s\n", "  map and vectors, heap", batch_heap);
+    std::printf("%-26s %8.3f s\n", "  flat arrays, one arena", batch_arena);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "differential.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+using std::string;
+
+// Throughput of every ReadEngine on the same words, next to whether it agreed
+// with Read. Engines that build structures over their input (trees, caches,
+// rebuilt tables) pay for them in every round, as they would for a new batch.
+// The state-map engines do work proportional to the number of states for every
+// word, so the default automaton is small; they are meant for long texts.
+int main(int argc, char** argv)
+{
+    size_t num_states = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t num_words = argc > 2 ? std::stoul(argv[2]) : 20000;
+    size_t max_length = argc > 3 ? std::stoul(argv[3]) : 128;
+    const int rounds = 3;
+
+    std::mt19937_64 rng(49);
+    Automaton dfa = GenerateAutomaton(rng, num_states, 16);
+    vector<string> words = GenerateWords(rng, dfa, num_words, max_length);
+    vector<std::string_view> views(words.begin(), words.end());
+    size_t bytes = 0;
+    for (const auto& word : words) {
+        bytes += word.size();
+    }
+
+    vector<ReadResult> expected;
+    ReferenceRead(dfa, views, expected);
+    size_t invalid = 0;
+    for (ReadResult r : expected) {
+        invalid += r == ReadResult::InvalidSymbol;
+    }
+    std::printf("states=%zu words=%zu bytes=%zu invalid=%zu\n", num_states, num_words, bytes, invalid);
+
+    auto time = [&](auto&& run) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            run();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        return static_cast<double>(bytes) * rounds / elapsed.count() / 1e6;
+    };
+
+    const double reference = time([&] { ReferenceRead(dfa, views, expected); });
+    std::printf("%-28s %10.1f MB/s  %6s  %s\n", "Automaton::Read", reference, "1.0x", "reference");
+
+    int failures = 0;
+    vector<ReadResult> results;
+    for (const auto& engine : ReadEngines()) {
+        const double rate = time([&] { engine.run(dfa, views, results); });
+        size_t wrong = 0;
+        if (results.size() != expected.size()) {
+            wrong = expected.size();
+        } else {
+            for (size_t i = 0; i < expected.size(); i++) {
+                wrong += results[i] != expected[i];
+            }
+        }
+        failures += wrong > 0;
+        std::printf("%-28s %10.1f MB/s  %5.1fx  %s\n", engine.name.c_str(), rate, rate / reference,
+                    wrong == 0 ? "agrees" : (std::to_string(wrong) + " words differ").c_str());
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "automaton.h"
+#include "table_export.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// The original printer: one stream insertion per cell and std::endl per row
+void ReferencePrint(const Automaton& dfa, std::ostream& out)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    const auto& accepting = dfa.GetAcceptingStates();
+    out << "Transition Table:" << std::endl;
+    out << "----------------" << std::endl;
+    out << "State |";
+    for (const auto& pair : dfa.GetAlphabet()) {
+        out << " '" << pair.first << "' |";
+    }
+    out << std::endl;
+    out << "------|";
+    for (size_t i = 0; i < dfa.GetAlphabet().size(); i++) {
+        out << "-----|";
+    }
+    out << std::endl;
+    for (size_t i = 0; i < M.size(); i++) {
+        out << "  " << i << "   |";
+        for (size_t j = 0; j < M[i].size(); j++) {
+            out << "  " << M[i][j] << "  |";
+        }
+        if (std::find(accepting.begin(), accepting.end(), i) != accepting.end()) {
+            out << " (accepting)";
+        }
+        out << std::endl;
+    }
+}
+
+template <typename F>
+double Seconds(F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t num_states = argc > 1 ? std::stoul(argv[1]) : 50000;
+    string path = argc > 2 ? argv[2] : "bench_export.txt";
+
+    std::mt19937 rng(7);
+    map<char, int> alphabet;
+    for (char c = 'a'; c <= 'z'; c++) {
+        alphabet[c] = c - 'a';
+    }
+    std::uniform_int_distribution<int> pick_state(0, static_cast<int>(num_states) - 1);
+    vector<vector<int>> M(num_states, vector<int>(alphabet.size()));
+    for (auto& row : M) {
+        for (auto& target : row) {
+            target = pick_state(rng);
+        }
+    }
+    vector<int> accepting;
+    for (size_t i = 0; i < num_states; i += 3) {
+        accepting.push_back(static_cast<int>(i));
+    }
+    Automaton dfa(alphabet, M, accepting);
+
+    double reference = Seconds([&] {
+        std::ofstream out(path);
+        ReferencePrint(dfa, out);
+    });
+    double text = Seconds([&] { ExportTableFile(dfa, path, TableFormat::Text); });
+    double dot = Seconds([&] { ExportTableFile(dfa, path, TableFormat::Dot); });
+    double csv = Seconds([&] { ExportTableFile(dfa, path, TableFormat::Csv); });
+    std::remove(path.c_str());
+
+    std::printf("states=%zu symbols=%zu\n", num_states, alphabet.size());
+    std::printf("%-24s %8.3f s\n", "reference (endl per row)", reference);
+    std::printf("%-24s %8.3f s  (%.1fx)\n", "ExportTable text", text, reference / text);
+    std::printf("%-24s %8.3f s\n", "ExportTable dot", dot);
+    std::printf("%-24s %8.3f s\n", "ExportTable csv", csv);
+    return 0;
+}
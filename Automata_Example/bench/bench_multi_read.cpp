@@ -0,0 +1,93 @@
+#include "automaton.h"
+#include "multi_read.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+template <typename F>
+double MegabytesPerSecond(size_t bytes, int rounds, F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        f();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(bytes) * rounds / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t num_states = argc > 1 ? std::stoul(argv[1]) : 4096;
+    size_t num_words = argc > 2 ? std::stoul(argv[2]) : 200000;
+    size_t word_length = argc > 3 ? std::stoul(argv[3]) : 64;
+    const int rounds = 5;
+
+    // Every state live and none absorbing, so each word is read to its end
+    std::mt19937 rng(41);
+    map<char, int> alphabet;
+    for (char c = 'a'; c <= 'z'; c++) {
+        alphabet[c] = c - 'a';
+    }
+    std::uniform_int_distribution<int> pick_state(0, static_cast<int>(num_states) - 1);
+    vector<vector<int>> M(num_states, vector<int>(alphabet.size()));
+    for (auto& row : M) {
+        for (auto& target : row) {
+            target = pick_state(rng);
+        }
+    }
+    vector<int> accepting;
+    for (size_t i = 0; i < num_states; i += 2) {
+        accepting.push_back(static_cast<int>(i));
+    }
+    Automaton dfa(alphabet, M, accepting);
+
+    string corpus(num_words * word_length, 'a');
+    std::uniform_int_distribution<int> pick_char(0, 25);
+    for (auto& c : corpus) {
+        c = static_cast<char>('a' + pick_char(rng));
+    }
+    vector<std::string_view> words;
+    vector<string> copies;
+    for (size_t i = 0; i < num_words; i++) {
+        words.emplace_back(corpus.data() + i * word_length, word_length);
+        copies.emplace_back(words.back());
+    }
+
+    vector<ReadResult> expected(num_words);
+    Automaton reader = dfa;
+    for (size_t i = 0; i < num_words; i++) {
+        expected[i] = reader.Read(copies[i]) ? ReadResult::Accepted : ReadResult::Rejected;
+    }
+
+    std::printf("states=%zu words=%zu length=%zu\n", num_states, num_words, word_length);
+    volatile bool sink = false;
+    double single = MegabytesPerSecond(corpus.size(), rounds, [&] {
+        for (const string& word : copies) {
+            sink = reader.Read(word);
+        }
+    });
+    std::printf("%-22s %10.1f MB/s\n", "Automaton::Read", single);
+
+    vector<ReadResult> results;
+    for (size_t lanes : {size_t{1}, size_t{4}, size_t{8}, size_t{16}}) {
+        double rate = MegabytesPerSecond(corpus.size(), rounds, [&] { ReadMany(dfa, words, results, lanes); });
+        if (results != expected) {
+            std::fprintf(stderr, "ReadMany with %zu lanes disagrees with Read\n", lanes);
+            return 1;
+        }
+        std::printf("ReadMany, %2zu lanes     %10.1f MB/s  (%.1fx)\n", lanes, rate, rate / single);
+    }
+    return 0;
+}
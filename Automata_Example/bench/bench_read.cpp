@@ -0,0 +1,109 @@
+#include "automaton.h"
+#include "transducer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// The original Read loop: map lookup, nested vectors and signed state
+bool ReferenceRead(const map<char, int>& alphabet, const vector<vector<int>>& M,
+                   const vector<int>& accepting, const string& word)
+{
+    int state = 0;
+    for (auto& c : word) {
+        auto it = alphabet.find(c);
+        if (it == alphabet.end()) {
+            return false;
+        }
+        size_t j = static_cast<size_t>(it->second);
+        state = M[static_cast<size_t>(state)][j];
+    }
+    return std::find(accepting.begin(), accepting.end(), state) != accepting.end();
+}
+
+template <typename F>
+double MegabytesPerSecond(size_t bytes, int rounds, F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        f();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(bytes) * rounds / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t num_states = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t text_size = argc > 2 ? std::stoul(argv[2]) : (16u << 20);
+    const int rounds = 5;
+
+    std::mt19937 rng(42);
+    map<char, int> alphabet;
+    for (char c = 'a'; c <= 'z'; c++) {
+        alphabet[c] = c - 'a';
+    }
+    std::uniform_int_distribution<int> pick_state(0, static_cast<int>(num_states) - 1);
+    vector<vector<int>> M(num_states, vector<int>(alphabet.size()));
+    for (auto& row : M) {
+        for (auto& target : row) {
+            target = pick_state(rng);
+        }
+    }
+    vector<int> accepting;
+    for (size_t i = 0; i < num_states; i += 2) {
+        accepting.push_back(static_cast<int>(i));
+    }
+
+    string text(text_size, 'a');
+    std::uniform_int_distribution<int> pick_char(0, 25);
+    for (auto& c : text) {
+        c = static_cast<char>('a' + pick_char(rng));
+    }
+
+    Automaton dfa(alphabet, M, accepting);
+    bool expected = ReferenceRead(alphabet, M, accepting, text);
+    if (dfa.Read(text) != expected) {
+        std::fprintf(stderr, "engines disagree\n");
+        return 1;
+    }
+
+    volatile bool sink = false;
+    double reference = MegabytesPerSecond(text.size(), rounds, [&] {
+        sink = ReferenceRead(alphabet, M, accepting, text);
+    });
+    double compiled = MegabytesPerSecond(text.size(), rounds, [&] { sink = dfa.Read(text); });
+
+    // Same table on transparent huge pages, to see what the TLB misses cost
+    Automaton huge(alphabet, M, accepting, Validation::Full, {HugePages::Transparent, false});
+    double huge_pages = MegabytesPerSecond(text.size(), rounds, [&] { sink = huge.Read(text); });
+
+    // Same machine emitting the target state as its output code
+    vector<vector<Transducer::Output>> O(num_states, vector<Transducer::Output>(alphabet.size()));
+    for (size_t q = 0; q < num_states; q++) {
+        for (size_t c = 0; c < alphabet.size(); c++) {
+            O[q][c] = static_cast<Transducer::Output>(M[q][c]);
+        }
+    }
+    Transducer tagger(alphabet, M, accepting, O);
+    vector<Transducer::Output> outputs(text.size());
+    double tagging = MegabytesPerSecond(text.size(), rounds, [&] { sink = tagger.Read(text, outputs.data()); });
+
+    std::printf("states=%zu text=%zu bytes\n", num_states, text.size());
+    std::printf("%-22s %10.1f MB/s\n", "reference (map+vector)", reference);
+    std::printf("%-22s %10.1f MB/s  (%.1fx)\n", "Automaton::Read", compiled, compiled / reference);
+    std::printf("%-22s %10.1f MB/s  (%.1fx)\n", "Read, huge pages", huge_pages, huge_pages / reference);
+    std::printf("%-22s %10.1f MB/s  (%.1fx)\n", "Transducer::Read", tagging, tagging / reference);
+    return 0;
+}
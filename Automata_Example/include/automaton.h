@@ -1,33 +1,136 @@
 #ifndef AUTOMATON_H
 #define AUTOMATON_H
 
+#include "byte_classes.h"
+#include "dfa_table.h"
+#include "table_memory.h"
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <map>
 #include <stdexcept>
 
+// Trusted input skips every consistency check and must only be used for
+// definitions that were validated before, e.g. loaded from a checksummed file.
+enum class Validation
+{
+    Full,
+    Trusted
+};
+
+// The definition and compiled table are immutable after construction and are
+// shared between copies, so copying an Automaton only duplicates its current state.
+// `placement` decides how the compiled table's memory is allocated; see TablePlacement.
+//
+// With an arena in `placement`, the shared definition and its table live in the
+// arena, so a batch of automata can be built into one buffer and released at
+// once. The flat-array constructor then allocates nothing on the heap.
 class Automaton
 {
 public:
-    Automaton(std::map<char, int> A, std::vector<std::vector<int>> M, std::vector<int> S_A);
-    bool Read(std::string word, bool reset = true);
+    Automaton(std::map<char, int> A, std::vector<std::vector<int>> M, std::vector<int> S_A,
+              Validation validation = Validation::Full, TablePlacement placement = TablePlacement());
+    // Alphabet given as byte classes: row i of M has one entry per class
+    Automaton(ByteClasses A, std::vector<std::vector<int>> M, std::vector<int> S_A,
+              Validation validation = Validation::Full, TablePlacement placement = TablePlacement());
+    // The matrix as one row-major array, transitions[s * A.NumColumns() + c],
+    // and the accepting states as S_A[0, num_accepting). Neither is kept.
+    Automaton(const ByteClasses& A, size_t num_states, const int* transitions, const int* S_A,
+              size_t num_accepting, Validation validation = Validation::Full,
+              TablePlacement placement = TablePlacement());
+
+    // Upper bound on the arena bytes one automaton of this size takes,
+    // construction scratch included, for sizing a buffer up front
+    static size_t ArenaBytes(size_t num_states, size_t num_columns);
+
+    bool Read(const std::string& word, bool reset = true);
     void Reset();
     void PrintCurrentState() const;
     void PrintTransitionTable() const;
     bool IsInAcceptingState() const;
 
+    // Read-only access to the definition, used by the algorithms built on top
+    int GetInitialState() const { return static_cast<int>(def->initial_state); }
+    size_t GetNumStates() const { return def->num_states; }
+    const ByteClasses& GetByteClasses() const { return def->alphabet; }
+    size_t GetNumColumns() const { return def->alphabet.NumColumns(); }
+    // Only the byte classes are stored; the map is rebuilt on each call
+    std::map<char, int> GetAlphabet() const { return def->alphabet.ToMap(); }
+    // Automata built in an arena or from flat arrays rebuild these from the
+    // table on first use, on the heap, with the accepting states in increasing order
+    const std::vector<std::vector<int>>& GetTransitionMatrix() const { return def->Nested().transition_matrix; }
+    const std::vector<int>& GetAcceptingStates() const { return def->Nested().accepting_states; }
+    // With NUMA replicas this is the copy local to the calling thread's node;
+    // all copies are identical, so rows from one are valid in every other.
+    const DfaTable& GetTable() const { return def->LocalTable(); }
+    size_t GetNumReplicas() const { return def->replicas.size(); }
+
+    // A dead state can never reach an accepting state, though it may still move
+    // between other dead states. A sink is a state whose every transition loops
+    // back to itself; an accepting sink is one that accepts. Read stops consuming
+    // input once it enters a sink, accepting or not, so the current state stays
+    // exact but symbols after that point are not checked: "a#" returns instead of
+    // throwing when "a" leads to a sink.
+    bool IsDeadState(int s) const { return !def->live[static_cast<size_t>(s)]; }
+    bool IsAcceptingSink(int s) const
+    {
+        return def->absorbing[static_cast<size_t>(s)] && def->live[static_cast<size_t>(s)];
+    }
+
 private:
-    int state;
-    int initial_state;
-    std::map<char, int> alphabet;
-    std::vector<std::vector<int>> transition_matrix;
-    std::vector<int> accepting_states;
-    int num_states;
+    struct Definition
+    {
+        explicit Definition(std::pmr::memory_resource* memory) : live(memory), absorbing(memory), table(memory) {}
+
+        size_t initial_state = 0;
+        size_t num_states = 0;
+        ByteClasses alphabet;
+        std::pmr::vector<bool> live;       // can still reach an accepting state
+        std::pmr::vector<bool> absorbing;  // every transition loops back to the state
+        DfaTable table;                    // what Read actually executes
+        std::vector<std::unique_ptr<const DfaTable>> replicas;  // one per NUMA node, or none
+        NumaTopology topology;             // only filled in when there are replicas
+
+        // The definition as given to the vector constructors on the heap;
+        // otherwise built from the table by the first Nested() call
+        mutable std::once_flag nested_once;
+        mutable std::vector<std::vector<int>> transition_matrix;
+        mutable std::vector<int> accepting_states;
+
+        const DfaTable& LocalTable() const
+        {
+            return replicas.empty() ? table : *replicas[topology.CurrentNode()];
+        }
+        const Definition& Nested() const;
+    };
+
+    std::shared_ptr<const Definition> def;
+    DfaTable::StateId state;  // current state, as a row base into def->table
 
     // Helper validation methods
-    void ValidateAlphabet(const std::map<char, int>& A);
-    void ValidateTransitionMatrix(const std::vector<std::vector<int>>& M, size_t alphabet_size);
-    void ValidateAcceptingStates(const std::vector<int>& S_A);
+    static void ValidateAlphabet(const std::map<char, int>& A);
+    static ByteClasses ClassesOf(const std::map<char, int>& A, Validation validation);
+    static void ValidateAcceptingStates(const int* S_A, size_t num_accepting, size_t num_states);
+
+    // Validates the matrix (unless trusted) in the same pass that flattens it
+    static std::pmr::vector<uint32_t> FlattenTransitionMatrix(const std::vector<std::vector<int>>& M,
+                                                              size_t num_columns, bool validate,
+                                                              std::pmr::memory_resource* memory);
+    static std::pmr::vector<uint32_t> FlattenTransitions(const int* transitions, size_t num_states,
+                                                         size_t num_columns, bool validate,
+                                                         std::pmr::memory_resource* memory);
+    static void CopyRow(const int* row, size_t num_columns, size_t num_states, size_t state, bool validate,
+                        uint32_t* out);
+    static std::pmr::vector<bool> AcceptingFlags(const int* S_A, size_t num_accepting, size_t num_states,
+                                                 std::pmr::memory_resource* memory);
+    // Fills in everything but the nested matrix from the flattened one;
+    // temporary arrays come from `scratch`
+    static void Build(Definition& d, const std::pmr::vector<uint32_t>& flat, const std::pmr::vector<bool>& accepting,
+                      const TablePlacement& placement, std::pmr::memory_resource* scratch);
+    static void FindAbsorbingStates(Definition& d, const std::pmr::vector<uint32_t>& flat,
+                                    const std::pmr::vector<bool>& accepting, std::pmr::memory_resource* scratch);
 };
 
 #endif // AUTOMATON_H
@@ -0,0 +1,33 @@
+#ifndef AUTOMATON_IO_H
+#define AUTOMATON_IO_H
+
+#include "automaton.h"
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Plain-text DFA definition:
+//
+//     # comments and blank lines are ignored
+//     alphabet ab        <- the i-th character is alphabet column i
+//     accepting 1        <- accepting states, may be empty
+//     0 1                <- one row of the transition matrix per state
+//     0 1
+//
+// Instead of the alphabet line, "classes [a-z] [0-9_]" gives one byte class
+// per column in ByteClasses::Parse syntax, separated by spaces (write a space
+// inside a class as \x20). SaveAutomaton uses it when a column holds several
+// characters. The initial state is always state 0, as for the constructor.
+Automaton LoadAutomaton(std::istream& in);
+Automaton LoadAutomatonFile(const std::string& path);
+
+void SaveAutomaton(std::ostream& out, const Automaton& dfa);
+
+// Binary DFA image in host byte order, ending in an FNV-1a 64-bit checksum of
+// everything before it. The alphabet is stored as the 256-entry byte class
+// table; images of the older (symbol, column) pair layout still load. Only the checksum is verified on load; the definition
+// itself is trusted and skips Automaton's validation pass.
+void SaveAutomatonBinary(std::ostream& out, const Automaton& dfa);
+Automaton LoadAutomatonBinary(std::istream& in);
+
+#endif // AUTOMATON_IO_H
@@ -0,0 +1,52 @@
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Collects output in one fixed-size buffer and hands it to the stream or FILE
+// in large blocks, so callers can write cell by cell without per-call
+// formatting or flushing costs. The destructor flushes whatever is left.
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(std::ostream& out, size_t capacity = 1 << 16);
+    explicit BufferedWriter(std::FILE* file, size_t capacity = 1 << 16);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void Write(std::string_view text);
+    void Put(char c)
+    {
+        if (used == buffer.size()) {
+            Flush();
+        }
+        buffer[used++] = c;
+    }
+
+    template <typename Integer>
+    void WriteInt(Integer value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        Write(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    void Flush();
+
+private:
+    std::ostream* stream = nullptr;
+    std::FILE* file = nullptr;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+    void WriteOut(const char* data, size_t n);
+};
+
+#endif // BUFFERED_WRITER_H
@@ -0,0 +1,60 @@
+#ifndef BYTE_CLASSES_H
+#define BYTE_CLASSES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// The alphabet of an automaton as a byte -> column table. Any number of bytes
+// may share a column, so a large alphabet costs no more than its number of
+// distinct columns, and the table is what the compiled DfaTable indexes with.
+class ByteClasses
+{
+public:
+    static constexpr std::uint16_t kNoColumn = 0xFFFF;
+
+    ByteClasses() { column_of.fill(kNoColumn); }
+
+    // One character class per column, e.g. {"[a-z]", "[0-9_]", "[^a-z0-9_]"}.
+    // A class in brackets lists characters and ranges, with a leading '^'
+    // taking the complement over all 256 bytes; '\' escapes the next character,
+    // and \n, \t, \r, \0 and \xHH name control and high bytes. A class without
+    // brackets is just the set of its characters. Each byte may belong to at
+    // most one class, and no class may be empty except "[]", which stands for
+    // a column no byte maps to (the map form allows such unused columns).
+    static ByteClasses Parse(const std::vector<std::string>& classes);
+
+    // The map form used by Automaton's constructor: column values must be below
+    // the map size, which is also the number of columns.
+    static ByteClasses FromMap(const std::map<char, int>& alphabet);
+
+    // A table in the form Table() returns, e.g. read back from a file
+    static ByteClasses FromTable(const std::array<std::uint16_t, 256>& column_of, std::size_t num_columns);
+
+    // Column of `c`, or -1 when it is not in the alphabet
+    int ColumnOf(char c) const
+    {
+        std::uint16_t col = column_of[static_cast<unsigned char>(c)];
+        return col == kNoColumn ? -1 : col;
+    }
+    bool Contains(char c) const { return ColumnOf(c) >= 0; }
+
+    std::size_t NumColumns() const { return num_columns; }
+    std::size_t NumSymbols() const;
+
+    // Characters of one column in byte order, and the same as a class that Parse accepts
+    std::string Symbols(std::size_t column) const;
+    std::string Describe(std::size_t column) const;
+
+    std::map<char, int> ToMap() const;
+    const std::array<std::uint16_t, 256>& Table() const { return column_of; }
+
+private:
+    std::array<std::uint16_t, 256> column_of;
+    std::size_t num_columns = 0;
+};
+
+#endif // BYTE_CLASSES_H
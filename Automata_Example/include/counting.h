@@ -0,0 +1,95 @@
+#ifndef COUNTING_H
+#define COUNTING_H
+
+#include "automaton.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary-precision unsigned integer with only the operations word counting needs
+class BigCount
+{
+public:
+    BigCount() = default;
+    BigCount(uint64_t value);
+
+    // this += x * factor
+    void AddMultiple(const BigCount& x, uint32_t factor);
+
+    bool operator==(const BigCount& other) const { return limbs == other.limbs; }
+    bool operator!=(const BigCount& other) const { return limbs != other.limbs; }
+
+    uint64_t Mod(uint64_t modulus) const;
+    std::string ToString() const;
+
+private:
+    std::vector<uint32_t> limbs;  // little-endian base 2^32, no leading zero limbs
+};
+
+// Number of words of exactly `length` symbols accepted by the automaton. Every
+// character of the alphabet counts as its own symbol, even when several share a column.
+
+// Exact count by dynamic programming over the transition matrix:
+// O(length * states * symbols) big-integer additions. Meant for small lengths.
+BigCount CountAcceptedWords(const Automaton& dfa, size_t length);
+
+// Count modulo `modulus` (non-zero). Short lengths use the same dynamic
+// programming; long ones raise the symbol-count matrix to the power `length`
+// by repeated squaring, O(states^3 log length), with each matrix product split
+// over threads by row ranges.
+uint64_t CountAcceptedWordsMod(const Automaton& dfa, uint64_t length, uint64_t modulus);
+
+// Draws accepted words uniformly at random among all accepted words of a
+// given length. The constructor computes, for every reachable state and every
+// remaining length up to `max_length`, how many accepted completions leave
+// through each outgoing edge; a symbol then costs one random number and a
+// binary search over the state's edges. Counts are kept in doubles rescaled
+// per length, so the distribution is uniform up to floating-point rounding.
+// The tables take O(max_length * states * distinct targets) doubles.
+class WordSampler
+{
+public:
+    WordSampler(const Automaton& dfa, size_t max_length);
+
+    size_t GetMaxLength() const { return max_length; }
+    bool HasWords(size_t length) const;
+
+    // Appends one accepted word of exactly `length` symbols to `out`. Returns
+    // false and leaves `out` untouched when there is no such word.
+    bool Sample(size_t length, std::mt19937_64& rng, std::string& out) const;
+
+    // Words stored back to back: word i is data[offsets[i], offsets[i + 1])
+    struct Corpus
+    {
+        std::string data;
+        std::vector<size_t> offsets;
+
+        size_t Size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        std::string_view Word(size_t i) const
+        {
+            return std::string_view(data).substr(offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    };
+
+    // Samples `count` words into one buffer. Each word's length is drawn with
+    // probability proportional to length_weights[length]; lengths without
+    // accepted words are skipped. Weighting by CountAcceptedWords makes the
+    // whole corpus uniform over all accepted words in the length range.
+    Corpus SampleCorpus(size_t count, const std::vector<double>& length_weights,
+                        std::mt19937_64& rng) const;
+
+private:
+    size_t max_length;
+    std::vector<size_t> offset;         // state -> first edge
+    std::vector<uint32_t> target;       // edge -> target state
+    std::vector<size_t> symbol_offset;  // edge -> first character in `symbols`
+    std::string symbols;
+    std::vector<bool> has_words;        // per length, from the initial state
+    // cumulative[(remaining - 1) * edges + e]: completions of length `remaining`
+    // through the edges of e's state up to and including e
+    std::vector<double> cumulative;
+};
+
+#endif // COUNTING_H
@@ -0,0 +1,75 @@
+#ifndef DFA_TABLE_H
+#define DFA_TABLE_H
+
+#include "byte_classes.h"
+#include "table_memory.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Compiled execution form of an Automaton.
+//
+// States are identified by their row base in `next` (state index * stride), so a
+// step is one load from `column_of` and one from `next` with no multiply and no
+// signed/unsigned conversion. Every row has one extra column that all bytes
+// outside the alphabet map to; it leads to the sentinel row 0.
+//
+// Rows are ordered so that the "special" states come first: the invalid-symbol
+// sentinel, then sinks, states whose every transition loops back to themselves.
+// Any row below `special_end` ends a scan, which costs a single compare per
+// step; since a sink never moves, the row a scan stops at is still exact.
+struct DfaTable
+{
+    using StateId = std::uint32_t;
+    static constexpr StateId kInvalidRow = 0;
+
+    std::array<std::uint16_t, 256> column_of{};  // byte -> column, stride - 1 when not in the alphabet
+    StateId stride = 0;                          // number of columns + 1
+    StateId start = 0;                           // row of the initial state
+    StateId special_end = 0;                     // rows below this stop a scan
+    std::vector<StateId, TableAllocator<StateId>> next;  // next[row + column] = target row
+    std::pmr::vector<std::uint8_t> accepting;    // indexed by row / stride
+    std::pmr::vector<std::uint32_t> state_of;    // row / stride -> original state number
+    std::pmr::vector<StateId> row_of;            // original state number -> row
+
+    explicit DfaTable(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : accepting(memory), state_of(memory), row_of(memory)
+    {
+    }
+
+    // `transitions` is the validated transition matrix flattened row by row in
+    // original state order: transitions[state * columns + column], and
+    // `accepting` flags the accepting states. `next` is allocated according to
+    // `placement` (copies of the table keep it), the other arrays from the
+    // arena or the default resource.
+    static DfaTable Compile(const ByteClasses& alphabet,
+                            const std::uint32_t* transitions,
+                            const std::pmr::vector<bool>& accepting,
+                            const std::pmr::vector<bool>& absorbing,
+                            std::size_t initial_state,
+                            const TablePlacement& placement = TablePlacement());
+
+    bool IsAccepting(StateId row) const { return accepting[row / stride] != 0; }
+    std::uint32_t StateOf(StateId row) const { return state_of[row / stride]; }
+
+    StateId Step(StateId row, unsigned char byte) const { return next[row + column_of[byte]]; }
+
+    // Advances `row` over [first, last), stopping after the first special row is
+    // entered. Returns the position where the scan stopped.
+    const char* Run(StateId& row, const char* first, const char* last) const
+    {
+        const StateId* table = next.data();
+        const std::uint16_t* columns = column_of.data();
+        StateId r = row;
+        while (first != last && r >= special_end) {
+            r = table[r + columns[static_cast<unsigned char>(*first)]];
+            ++first;
+        }
+        row = r;
+        return first;
+    }
+};
+
+#endif // DFA_TABLE_H
@@ -0,0 +1,70 @@
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include "automaton.h"
+#include "multi_read.h"
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Differential testing of the engines that decide words for an Automaton.
+//
+// Every engine answers the question Automaton::Read answers (is the word
+// accepted, or does it hold a symbol outside the alphabet?) but gets there
+// differently: lockstep lanes, composed state maps, segment trees, caches, a
+// rebuilt or minimized table. They are run on the same words and compared with
+// Read itself, which stays the reference.
+//
+// Transducer is deliberately not an engine: it checks every symbol, also after
+// a sink, where Read stops looking at the input, so the two differ by design
+// on words with invalid symbols past that point.
+struct ReadEngine
+{
+    std::string name;
+    // Writes results[i] for words[i]. Engines that need structures over the
+    // input (a tree over the batch, a cache) build them inside the call, so
+    // words of one batch may hit entries left by earlier ones.
+    std::function<void(const Automaton&, const std::vector<std::string_view>&, std::vector<ReadResult>&)> run;
+    // Set for engines that keep the language of the automaton but not its
+    // states, like a minimized table. Read only stops early at sinks, and such
+    // an engine may enter one sooner and skip a symbol Read reports as
+    // invalid, so it is only given the words over the alphabet.
+    bool alphabet_only = false;
+};
+
+// Every engine of the library, in a fixed order
+const std::vector<ReadEngine>& ReadEngines();
+
+// Automaton::Read on each word, with its exception reported as InvalidSymbol
+void ReferenceRead(const Automaton& dfa, const std::vector<std::string_view>& words, std::vector<ReadResult>& results);
+
+struct Disagreement
+{
+    std::string engine;
+    size_t word = 0;  // index of the first word the engine got wrong
+    ReadResult expected = ReadResult::Rejected;
+    ReadResult actual = ReadResult::Rejected;
+    std::string error;  // set instead when the engine threw
+
+    std::string Describe(const std::vector<std::string_view>& words) const;
+};
+
+// Runs each engine on the words and returns one entry per engine that
+// disagrees with Read or throws.
+std::vector<Disagreement> CompareEngines(const Automaton& dfa, const std::vector<std::string_view>& words,
+                                         const std::vector<ReadEngine>& engines = ReadEngines());
+
+// A random automaton over `num_columns` columns of one or two random bytes
+// each. About a quarter of the states are made rejecting or accepting sinks, so
+// the early exits of Read are taken.
+Automaton GenerateAutomaton(std::mt19937_64& rng, size_t num_states, size_t num_columns);
+
+// Random words of up to `max_length` bytes, mostly over the alphabet with the
+// occasional byte outside it. Some words repeat or extend earlier ones, as
+// the caches need.
+std::vector<std::string> GenerateWords(std::mt19937_64& rng, const Automaton& dfa, size_t count, size_t max_length);
+
+#endif // DIFFERENTIAL_H
@@ -0,0 +1,63 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "automaton.h"
+#include "multi_read.h"
+#include "state_map.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Keeps the verdict of one long word up to date while it is edited.
+//
+// The text is cut into segments of about `segment_size` bytes. Each segment
+// stores its StateMap, and a segment tree above them stores the composed maps
+// of every range of segments. An edit re-scans only the segments it touches
+// and recomposes their O(log segments) ancestors; Result() then costs one
+// lookup in the root map. When an edit splits or removes segments, all inner
+// nodes are recomposed (segment maps are kept), once per `segment_size`
+// inserted or erased bytes at most.
+//
+// Every node holds a map over all states, so memory is about
+// 2 * segments * states * 4 bytes: meant for automata with small state counts.
+class IncrementalMatcher
+{
+public:
+    IncrementalMatcher(const Automaton& dfa, std::string text, size_t segment_size = 4096);
+
+    // Same as std::string::replace(pos, count, replacement); count is clipped
+    // to the end of the text. Throws std::invalid_argument when pos > Size().
+    void Replace(size_t pos, size_t count, std::string_view replacement);
+    void Insert(size_t pos, std::string_view text) { Replace(pos, 0, text); }
+    void Erase(size_t pos, size_t count) { Replace(pos, count, std::string_view()); }
+
+    // What Read(Text()) would return, or InvalidSymbol where it would throw
+    ReadResult Result() const;
+    size_t Size() const { return lengths.empty() ? 0 : lengths[1]; }
+    std::string Text() const;
+
+private:
+    struct Segment
+    {
+        std::string text;
+        StateMap map;
+    };
+
+    Automaton dfa;
+    size_t segment_size;
+    std::vector<Segment> segments;
+    // Segment tree with `capacity` leaves; node i has children 2i and 2i + 1,
+    // leaf k is node capacity + k. Only inner nodes store a map here.
+    size_t capacity = 1;
+    std::vector<StateMap> inner;
+    std::vector<size_t> lengths;  // bytes under each node, leaves included
+    StateMap identity;
+
+    const StateMap& MapOf(size_t node) const;
+    void Update(size_t node);
+    void Rebuild();
+    size_t SegmentAt(size_t pos, size_t& offset) const;
+};
+
+#endif // INCREMENTAL_H
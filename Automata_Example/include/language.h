@@ -0,0 +1,40 @@
+#ifndef LANGUAGE_H
+#define LANGUAGE_H
+
+#include "automaton.h"
+#include <optional>
+#include <string>
+
+// Operations on the languages of automata. Two automata may use different
+// alphabets: a symbol missing from an automaton's alphabet is treated as
+// leading to a rejecting dead state there.
+
+// Equivalence is decided with Hopcroft-Karp union-find over the states of both
+// automata, which is near-linear in their size. Only when they differ is the
+// product explored breadth-first to produce a shortest word accepted by
+// exactly one of them.
+bool AreEquivalent(const Automaton& a, const Automaton& b);
+std::optional<std::string> FindDifference(const Automaton& a, const Automaton& b);
+
+// Inclusion L(a) ⊆ L(b), decided by a breadth-first search over the reachable
+// product states; the counterexample is a shortest word accepted by `a` but not by `b`.
+bool IsSubsetOf(const Automaton& a, const Automaton& b);
+std::optional<std::string> FindInclusionCounterexample(const Automaton& a, const Automaton& b);
+
+// Product constructions. Only product states reachable from the pair of
+// initial states are generated, and the result is minimized, so a composed
+// filter runs as a single table walk over the union of both alphabets. Its
+// columns are the distinct pairs of byte classes of the two inputs, so the
+// result is no wider than the inputs need.
+Automaton Intersection(const Automaton& a, const Automaton& b);
+Automaton Union(const Automaton& a, const Automaton& b);
+Automaton Difference(const Automaton& a, const Automaton& b);  // L(a) \ L(b)
+
+// Complement with respect to the automaton's own alphabet
+Automaton Complement(const Automaton& a);
+
+// Drops unreachable states and merges equivalent ones (Hopcroft's partition
+// refinement, O(n k log n)). The initial state stays state 0.
+Automaton Minimize(const Automaton& dfa);
+
+#endif // LANGUAGE_H
@@ -0,0 +1,52 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "automaton.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A token as the byte range [offset, offset + length) matched by rule `kind`
+struct Token
+{
+    int kind;
+    size_t offset;
+    size_t length;
+};
+
+// Splits a text into tokens with maximal-munch semantics: at each position the
+// longest non-empty prefix accepted by any rule becomes the next token, and
+// when several rules accept that same prefix the one listed first wins.
+//
+// All rules are combined up front into a single DFA whose states are tuples of
+// rule states, so a scan walks one table no matter how many rules there are.
+// Bytes that every rule treats alike share a column of that table, so a class
+// like [^a-z] costs one column, not one per byte. Each row carries
+// the kind accepted there in an extra column, next to its transitions. A scan that overshoots the longest match backs up
+// to it, so a pathological rule set can cost quadratic time in the worst case.
+class Lexer
+{
+public:
+    // Rule i produces tokens of kind i
+    explicit Lexer(const std::vector<Automaton>& rules);
+
+    // Replaces the contents of `tokens` (keeping its capacity) with the tokens
+    // of `text` and returns how many bytes were tokenized. A result short of
+    // text.size() is the offset where no rule matches.
+    size_t Tokenize(const std::string& text, std::vector<Token>& tokens) const;
+
+    size_t GetNumStates() const { return next.size() / stride; }
+    size_t GetNumColumns() const { return stride - 2; }
+
+private:
+    static constexpr uint32_t kDeadRow = 0;
+
+    std::array<uint16_t, 256> column_of{};  // byte -> column, the dead column when no rule uses it
+    uint32_t stride = 0;                    // columns + dead column + kind column
+    uint32_t start = 0;                     // row of the initial state
+    std::vector<uint32_t> next;             // next[row + column]; next[row + stride - 1] = kind + 1, or 0
+};
+
+#endif // LEXER_H
@@ -0,0 +1,31 @@
+#ifndef MULTI_READ_H
+#define MULTI_READ_H
+
+#include "automaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+enum class ReadResult : std::uint8_t
+{
+    Rejected,
+    Accepted,
+    InvalidSymbol  // where Automaton::Read would have thrown
+};
+
+// Runs the automaton over many independent words. A single Read is bound by
+// the latency of its chain of dependent table loads. Here up to 16 words are
+// stepped in lockstep in one loop, so that many loads are in flight at once;
+// `lanes` is rounded up to 1, 4, 8 or 16. A lane that finishes its word is
+// refilled with the next one. Lanes stop at sinks exactly like
+// Read, so results[i] is what Read(words[i]) returns, or InvalidSymbol where
+// it throws.
+//
+// With AUTOMATA_ENABLE_AVX2, lane counts that round up to 8 or 16 step with
+// vector gathers from the transition table instead. The gathers measured slower than the scalar
+// interleaving on the machines we tried, so the option is off by default.
+void ReadMany(const Automaton& dfa, const std::vector<std::string_view>& words,
+              std::vector<ReadResult>& results, size_t lanes = 8);
+
+#endif // MULTI_READ_H
@@ -0,0 +1,51 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Splits [0, n) into contiguous ranges of at least `min_chunk` items and runs
+// body(begin, end) on each range, one thread per range. Inputs too small to
+// split run inline on the calling thread. If ranges throw, the exception of the
+// lowest range is rethrown once every thread has finished, so the error is the
+// same one a sequential loop would have reported.
+template <typename Body>
+void ParallelFor(size_t n, size_t min_chunk, Body body)
+{
+    // hardware_concurrency() costs a system call, so small inputs skip it
+    size_t max_chunks = n / std::max<size_t>(1, min_chunk);
+    size_t chunks = max_chunks <= 1 ? 1 : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), max_chunks);
+    if (chunks <= 1) {
+        body(size_t{0}, n);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&](size_t c) {
+        try {
+            body(n * c / chunks, n * (c + 1) / chunks);
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; c++) {
+        threads.emplace_back(run, c);
+    }
+    run(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif // PARALLEL_FOR_H
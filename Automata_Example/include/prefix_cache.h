@@ -0,0 +1,92 @@
+#ifndef PREFIX_CACHE_H
+#define PREFIX_CACHE_H
+
+#include "automaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Remembers the state reached after prefixes of earlier words, so that words
+// sharing a long prefix (URLs, paths) resume from the deepest cached one
+// instead of rescanning it.
+//
+// Checkpoints sit every `granularity` bytes and form a trie: a checkpoint is
+// keyed by its parent and the next `granularity` bytes, and found through one
+// open-addressing hash table. The number of checkpoints is bounded by
+// `max_bytes`; when full, the least recently used leaf is evicted. A lookup
+// hashes `granularity` bytes per checkpoint, so the cache pays off once a
+// table step costs more than hashing a byte, i.e. for tables that do not fit
+// in cache.
+//
+// Read behaves exactly like Automaton::Read from the initial state, including
+// its exceptions. A cache is not thread-safe; use one per thread.
+class PrefixCache
+{
+public:
+    struct Stats
+    {
+        uint64_t reads = 0;
+        uint64_t hits = 0;           // reads that resumed from a cached prefix
+        uint64_t bytes_read = 0;
+        uint64_t bytes_skipped = 0;  // bytes covered by cached prefixes
+        uint64_t evictions = 0;
+
+        double HitRate() const { return reads == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(reads); }
+        double SkipRate() const
+        {
+            return bytes_read == 0 ? 0.0 : static_cast<double>(bytes_skipped) / static_cast<double>(bytes_read);
+        }
+    };
+
+    explicit PrefixCache(const Automaton& dfa, size_t max_bytes = size_t{16} << 20, size_t granularity = 16);
+
+    bool Read(std::string_view word);
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+    size_t GetNumEntries() const { return nodes.size() - 1 - free_nodes.size(); }
+    size_t GetMaxEntries() const { return max_nodes; }
+    void Clear();
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Node 0 is the empty prefix. The others are chained from newest to oldest
+    // use; a read touches its path from the deepest node up, so every node is
+    // newer than its children and the oldest node is always a leaf.
+    struct Node
+    {
+        uint64_t hash = 0;
+        DfaTable::StateId row = 0;
+        uint32_t parent = kNone;
+        uint32_t children = 0;
+        uint32_t newer = kNone;
+        uint32_t older = kNone;
+        uint32_t epoch = 0;  // last read that visited the node
+    };
+
+    Automaton dfa;
+    size_t granularity;
+    size_t max_nodes;
+    std::vector<Node> nodes;
+    std::string keys;  // node i's bytes at [i * granularity, (i + 1) * granularity)
+    std::vector<uint32_t> free_nodes;
+    std::vector<uint32_t> buckets;  // node ids, kNone when empty
+    uint32_t newest = kNone;
+    uint32_t oldest = kNone;
+    uint32_t epoch = 0;
+    std::vector<uint32_t> path;
+    Stats stats;
+
+    uint64_t Hash(uint32_t parent, std::string_view chunk) const;
+    uint32_t Find(uint32_t parent, std::string_view chunk, uint64_t hash) const;
+    uint32_t Add(uint32_t parent, std::string_view chunk, uint64_t hash, DfaTable::StateId row);
+    void EvictOne();
+    void EraseBucket(uint32_t id);
+    void Unlink(uint32_t id);
+    void PushNewest(uint32_t id);
+};
+
+#endif // PREFIX_CACHE_H
@@ -0,0 +1,53 @@
+#ifndef RANGE_MATCHER_H
+#define RANGE_MATCHER_H
+
+#include "automaton.h"
+#include "multi_read.h"
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Answers "what would Read return for buffer[begin, end)?" for many ranges of
+// one large buffer.
+//
+// The buffer is cut into blocks, and a segment tree over the blocks stores, for
+// every node, the state map of its bytes (see StateMap). A query scans the
+// partial blocks at both ends directly and crosses the whole blocks in between
+// with O(log blocks) node lookups; since only one state is followed, each node
+// costs a single load rather than a full composition.
+//
+// The tree takes about 2 * blocks * states * 4 bytes. The block size is the
+// smallest one that keeps this within `memory_budget`, so automata with few
+// states get fine blocks and large ones fall back to longer scans. Leaves and
+// every tree level are built in parallel. The buffer is not copied and must
+// outlive the matcher.
+class RangeMatcher
+{
+public:
+    RangeMatcher(const Automaton& dfa, std::string_view buffer, size_t memory_budget = size_t{64} << 20);
+
+    // Throws std::invalid_argument unless begin <= end <= buffer size
+    ReadResult Query(size_t begin, size_t end) const;
+    // Queries split over threads; results[i] answers ranges[i]
+    void QueryMany(const std::vector<std::pair<size_t, size_t>>& ranges, std::vector<ReadResult>& results) const;
+
+    size_t GetBlockSize() const { return block_size; }
+    size_t MemoryBytes() const { return maps.size() * sizeof(DfaTable::StateId); }
+
+private:
+    Automaton dfa;
+    std::string_view buffer;
+    size_t block_size = 0;
+    size_t num_blocks = 0;
+    size_t num_rows = 0;  // rows of the compiled table, i.e. entries per map
+    // Bottom-up segment tree: node i (1 <= i < 2 * num_blocks) has children 2i
+    // and 2i + 1, block k is node num_blocks + k. Node i's map starts at
+    // maps[(i - 1) * num_rows].
+    std::vector<DfaTable::StateId> maps;
+
+    const DfaTable::StateId* MapOf(size_t node) const { return maps.data() + (node - 1) * num_rows; }
+    DfaTable::StateId Scan(const DfaTable& table, DfaTable::StateId row, size_t begin, size_t end) const;
+};
+
+#endif // RANGE_MATCHER_H
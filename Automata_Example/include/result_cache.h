@@ -0,0 +1,87 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "automaton.h"
+#include "multi_read.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Memoizes the outcome of reading short words, for inputs that repeat often.
+//
+// Entries are keyed by the word's bytes and hold the final state and the
+// ReadResult. The cache is split into shards, each guarded by its own mutex
+// and picked by the word's hash, so threads sharing one cache rarely contend.
+// Every shard is a fixed array of slots with the key stored inline, indexed by
+// a linear-probing hash table, and evicts with the clock algorithm: a hit sets
+// the slot's reference bit, and the hand clears bits until it finds a slot
+// that was not used since its last pass.
+//
+// Memory is fixed at construction: about max_bytes, whatever the words are.
+// Words longer than max_word_length are read directly and never cached.
+class ResultCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypassed = 0;  // words too long to cache
+        uint64_t evictions = 0;
+
+        double HitRate() const
+        {
+            uint64_t lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+    explicit ResultCache(const Automaton& dfa, size_t max_bytes = size_t{64} << 20, size_t max_word_length = 64);
+
+    // Thread-safe. Returns what ReadMany would report for the word; when
+    // `final_state` is given and the word is valid, it receives the state the
+    // automaton is in after the word.
+    ReadResult Read(std::string_view word, uint32_t* final_state = nullptr);
+
+    Stats GetStats() const;
+    size_t GetCapacity() const { return shards.size() * slots_per_shard; }
+    void Clear();
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    struct Slot
+    {
+        uint64_t hash = 0;
+        uint32_t state = 0;
+        uint16_t length = 0;
+        ReadResult result = ReadResult::Rejected;
+        bool referenced = false;
+        bool used = false;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        std::vector<char> keys;        // slot i's bytes start at i * max_word_length
+        std::vector<uint32_t> index;   // slot ids, kEmpty when free
+        size_t hand = 0;
+        Stats stats;
+    };
+
+    Automaton dfa;
+    size_t max_word_length;
+    size_t slots_per_shard;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    ReadResult Compute(std::string_view word, uint32_t& state) const;
+    uint32_t Find(const Shard& shard, std::string_view word, uint64_t hash) const;
+    uint32_t Claim(Shard& shard);
+    void EraseIndex(Shard& shard, uint32_t slot);
+};
+
+#endif // RESULT_CACHE_H
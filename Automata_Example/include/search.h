@@ -0,0 +1,64 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "automaton.h"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A match of the automaton's language inside a text, as the half-open byte range [start, end)
+struct Match
+{
+    size_t start;
+    size_t end;
+};
+
+// Finds occurrences of an automaton's language inside a larger text using
+// leftmost-longest semantics.
+//
+// Three byte-level DFAs are compiled up front:
+//  - forward:  the language with a self-loop prefix (Sigma* L), so a single
+//              forward pass finds the earliest position where some match ends;
+//  - reverse:  the reversed prefixes of L, run backwards from that end to find
+//              every position where a match could still start;
+//  - anchored: the original DFA, run forward once from the leftmost candidate
+//              with every candidate start in lockstep, to pick the leftmost
+//              start that really matches and extend it to the longest match.
+// The reverse and anchored scans only run once a match is known to exist.
+// Candidates that reach the same anchored state are merged, so the anchored
+// scan costs O(length * min(candidates, states)) rather than one scan per
+// candidate, which was quadratic in the distance back from the match end.
+// Bytes outside the alphabet never take part in a match.
+class Searcher
+{
+public:
+    explicit Searcher(const Automaton& dfa);
+
+    std::optional<Match> Find(const std::string& text, size_t from = 0) const;
+    std::vector<Match> FindAll(const std::string& text) const;
+
+private:
+    struct ByteDfa
+    {
+        int start = 0;
+        std::vector<int> next;      // next[state * num_columns + column], -1 when dead
+        std::vector<bool> accepting;
+
+        int Step(int state, int column, size_t num_columns) const
+        {
+            return next[static_cast<size_t>(state) * num_columns + static_cast<size_t>(column)];
+        }
+    };
+
+    std::array<int, 256> column_of;  // byte -> alphabet column, -1 when not in the alphabet
+    size_t num_columns;
+    ByteDfa forward;
+    ByteDfa reverse;
+    ByteDfa anchored;
+
+    int Column(char c) const { return column_of[static_cast<unsigned char>(c)]; }
+};
+
+#endif // SEARCH_H
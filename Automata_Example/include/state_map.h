@@ -0,0 +1,52 @@
+#ifndef STATE_MAP_H
+#define STATE_MAP_H
+
+#include "automaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// What a piece of input does to every state of a compiled table: to[row / stride]
+// is the row reached when the piece is read from `row`. Steps follow Read, so
+// the special rows (sentinel and sinks) are fixed points and
+// bytes read after entering one are ignored.
+//
+// Maps of consecutive pieces compose, so a long input can be cut into chunks
+// that are mapped independently and combined afterwards in order.
+struct StateMap
+{
+    DfaTable::StateId stride = 0;
+    std::vector<DfaTable::StateId> to;
+    // Optional: for each start row, how many non-empty prefixes of the piece end
+    // in an accepting state. Empty when matches were not counted.
+    std::vector<std::uint64_t> matches;
+
+    static StateMap Identity(const DfaTable& table, bool count_matches = false);
+
+    DfaTable::StateId Apply(DfaTable::StateId row) const { return to[row / stride]; }
+    std::uint64_t MatchesFrom(DfaTable::StateId row) const { return matches[row / stride]; }
+};
+
+// Runs the piece from every state at once. States whose paths merge are then
+// carried as one, so the cost is the piece length times the number of paths
+// that are still distinct, plus O(states log states) bookkeeping.
+StateMap ComputeStateMap(const DfaTable& table, std::string_view piece, bool count_matches = false);
+
+// The map of `first` followed by `second`; both must come from the same table,
+// and matches are kept only when both counted them.
+StateMap Compose(const StateMap& first, const StateMap& second);
+
+// Result of scanning one long input as a single word
+struct ScanResult
+{
+    DfaTable::StateId row = 0;  // final row; DfaTable::kInvalidRow after an invalid symbol
+    std::uint64_t matches = 0;  // non-empty accepted prefixes
+};
+
+// Same outcome as reading `text` from the initial state, computed by mapping
+// chunks of at least `min_chunk` bytes on separate threads and composing the
+// maps. The first chunk only needs the initial state and is read directly.
+ScanResult ScanParallel(const Automaton& dfa, std::string_view text, size_t min_chunk = 1 << 20);
+
+#endif // STATE_MAP_H
@@ -0,0 +1,21 @@
+#ifndef TABLE_EXPORT_H
+#define TABLE_EXPORT_H
+
+#include "automaton.h"
+#include <ostream>
+#include <string>
+
+enum class TableFormat
+{
+    Text,  // the layout of Automaton::PrintTransitionTable
+    Dot,   // Graphviz digraph, parallel edges merged into one labelled edge
+    Csv    // one row per state: state, one column per symbol, accepting flag
+};
+
+// Writes the transition table through a single BufferedWriter, so output of
+// large automata costs a handful of block writes rather than one per cell.
+void ExportTable(const Automaton& dfa, std::ostream& out, TableFormat format = TableFormat::Text);
+// Throws std::runtime_error when the file cannot be opened, written or closed
+void ExportTableFile(const Automaton& dfa, const std::string& path, TableFormat format);
+
+#endif // TABLE_EXPORT_H
@@ -0,0 +1,118 @@
+#ifndef TABLE_MEMORY_H
+#define TABLE_MEMORY_H
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Where the pages behind a compiled transition table come from. Tables smaller
+// than one huge page always use the ordinary heap.
+enum class HugePages
+{
+    None,         // ordinary heap allocation
+    Transparent,  // huge-page aligned anonymous mapping advised with MADV_HUGEPAGE
+    Explicit      // MAP_HUGETLB from the reserved pool; Transparent when the pool is empty
+};
+
+struct TablePlacement
+{
+    HugePages huge_pages = HugePages::None;
+    // Keep one copy of the table per NUMA node, each written by a thread
+    // running on that node so first-touch places its pages there. Read then
+    // uses the copy of the node the calling thread runs on. Ignored on
+    // single-node machines.
+    bool numa_replicas = false;
+    // Allocate the whole automaton, including the scratch space of its
+    // construction, from this resource instead of the heap, e.g. a
+    // std::pmr::monotonic_buffer_resource shared by a batch of small automata.
+    // huge_pages and numa_replicas are ignored then. The resource must outlive
+    // the automaton and every copy of it.
+    std::pmr::memory_resource* arena = nullptr;
+};
+
+constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+// Throws std::bad_alloc when no memory can be mapped at all
+void* AllocateTableMemory(std::size_t bytes, HugePages huge_pages);
+void FreeTableMemory(void* p, std::size_t bytes, HugePages huge_pages);
+
+// Allocator carrying a HugePages policy or an arena, so the placement follows
+// the table through copies (a replica is allocated the same way as the original).
+template <typename T>
+class TableAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    TableAllocator() = default;
+    explicit TableAllocator(HugePages huge_pages, std::pmr::memory_resource* arena = nullptr)
+        : huge_pages(huge_pages), arena(arena)
+    {
+    }
+    template <typename U>
+    TableAllocator(const TableAllocator<U>& other) : huge_pages(other.GetHugePages()), arena(other.GetArena())
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (arena != nullptr) {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(AllocateTableMemory(n * sizeof(T), huge_pages));
+    }
+    void deallocate(T* p, std::size_t n)
+    {
+        if (arena != nullptr) {
+            arena->deallocate(p, n * sizeof(T), alignof(T));
+        } else {
+            FreeTableMemory(p, n * sizeof(T), huge_pages);
+        }
+    }
+
+    HugePages GetHugePages() const { return huge_pages; }
+    std::pmr::memory_resource* GetArena() const { return arena; }
+
+    template <typename U>
+    bool operator==(const TableAllocator<U>& other) const
+    {
+        return huge_pages == other.GetHugePages() && arena == other.GetArena();
+    }
+    template <typename U>
+    bool operator!=(const TableAllocator<U>& other) const { return !(*this == other); }
+
+private:
+    HugePages huge_pages = HugePages::None;
+    std::pmr::memory_resource* arena = nullptr;
+};
+
+// NUMA nodes of the machine, renumbered densely from 0 in the order of their
+// kernel ids. Machines without NUMA information are one node holding every CPU.
+struct NumaTopology
+{
+    std::vector<std::vector<int>> cpus;  // node -> CPUs on it
+    std::vector<int> node_of_cpu;        // CPU -> node, -1 for CPUs on no node
+
+    std::size_t NumNodes() const { return cpus.size(); }
+    // Node of the CPU the calling thread currently runs on, 0 when unknown
+    std::size_t CurrentNode() const;
+};
+
+// Parses a kernel CPU list such as "0-3,8,10-11"; throws std::invalid_argument
+std::vector<int> ParseCpuList(const std::string& list);
+
+// Reads /sys/devices/system/node
+NumaTopology DetectNumaTopology();
+
+// Runs body(node) once per node on a thread pinned to that node's CPUs. Nodes
+// run concurrently; the first exception (in node order) is rethrown after all
+// threads finished.
+void RunOnEachNode(const NumaTopology& topology, const std::function<void(std::size_t node)>& body);
+
+#endif // TABLE_MEMORY_H
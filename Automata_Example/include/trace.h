@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "automaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes the states visited while reading `word` from the initial state into
+// `out`: the initial state followed by one state per symbol. At most `capacity`
+// states are written; the full path length (word.size() + 1) is returned so a
+// short buffer can be detected. Unlike Read, the path does not stop at sinks.
+size_t TraceStates(const Automaton& dfa, const std::string& word, uint32_t* out, size_t capacity);
+
+// A state path stored as zigzag varint deltas between consecutive states.
+// Neighbouring states in a trace are usually close, so most steps take one byte.
+class TraceLog
+{
+public:
+    void Append(uint32_t state);
+    size_t Size() const { return count; }
+    std::vector<uint32_t> Decode() const;
+
+    const std::vector<uint8_t>& Bytes() const { return bytes; }
+    static TraceLog FromBytes(std::vector<uint8_t> data);
+
+    void WriteFile(const std::string& path) const;
+    static TraceLog ReadFile(const std::string& path);
+
+private:
+    std::vector<uint8_t> bytes;
+    uint32_t last = 0;
+    size_t count = 0;
+};
+
+TraceLog RecordTrace(const Automaton& dfa, const std::string& word);
+
+// Result of re-executing a word against a recorded trace. When the paths have
+// different lengths, the missing side of the first difference is reported as kNoState.
+struct TraceDiff
+{
+    static constexpr uint32_t kNoState = UINT32_MAX;
+
+    bool identical = true;
+    size_t position = 0;  // index into the state sequence of the first difference
+    uint32_t expected = kNoState;
+    uint32_t actual = kNoState;
+};
+
+TraceDiff ReplayTrace(const Automaton& dfa, const std::string& word, const TraceLog& recorded);
+
+#endif // TRACE_H
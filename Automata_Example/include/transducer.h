@@ -0,0 +1,46 @@
+#ifndef TRANSDUCER_H
+#define TRANSDUCER_H
+
+#include "automaton.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A Mealy machine: an Automaton whose transitions also emit an output code,
+// e.g. a token tag or a field index. The outputs are stored in a table with the
+// same layout as DfaTable::next, so tagging costs one extra load per symbol on
+// top of the plain table walk. Unlike Automaton::Read, a transducer consumes the
+// whole input even after entering a sink, since every symbol
+// still produces an output.
+class Transducer
+{
+public:
+    using Output = std::uint32_t;
+
+    // O has the shape of M: O[s][c] is emitted when M[s][c] is taken
+    Transducer(std::map<char, int> A, std::vector<std::vector<int>> M, std::vector<int> S_A,
+               const std::vector<std::vector<Output>>& O, Validation validation = Validation::Full);
+
+    // Writes the output of the i-th symbol to outputs[i]; the caller provides
+    // room for word.size() codes. Returns whether the final state is accepting.
+    // On an invalid symbol the outputs before it are written, the state is left
+    // just before it, and std::invalid_argument is thrown.
+    bool Read(const std::string& word, Output* outputs, bool reset = true);
+    void Reset();
+    bool IsInAcceptingState() const;
+
+    Output GetOutput(int s, char symbol) const;
+    const Automaton& GetAutomaton() const { return dfa; }
+
+private:
+    Automaton dfa;
+    std::shared_ptr<const std::vector<Output>> output;  // output[row + column], shared between copies
+    DfaTable::StateId state;
+
+    static void ValidateOutputs(const std::vector<std::vector<Output>>& O, size_t num_states,
+                                size_t alphabet_size);
+};
+
+#endif // TRANSDUCER_H
@@ -0,0 +1,35 @@
+#ifndef UTF8_ALPHABET_H
+#define UTF8_ALPHABET_H
+
+#include "automaton.h"
+#include <string>
+#include <vector>
+
+// Code points [first, last] form alphabet column `column`
+struct Utf8Symbol
+{
+    char32_t first;
+    char32_t last;
+    int column;
+};
+
+// Builds a byte-level Automaton that runs a DFA defined over Unicode code
+// points on UTF-8 text. Each symbol range is split into runs of UTF-8 byte
+// ranges, and every multi-byte sequence becomes a chain of intermediate
+// states, so the compiled Automaton still does one table lookup per byte and
+// never decodes. Intermediate states with identical transitions are merged,
+// so chains that only read free continuation bytes are shared between all
+// states with the same target.
+//
+// States 0 .. M.size() - 1 keep their numbers and meaning. A code point
+// outside the alphabet, a truncated sequence or malformed UTF-8 (overlong
+// forms, surrogates) leads to a rejecting dead state. A byte that starts no
+// encoding of the alphabet is an invalid symbol for Read.
+Automaton CompileUtf8Automaton(const std::vector<Utf8Symbol>& alphabet,
+                               const std::vector<std::vector<int>>& M,
+                               const std::vector<int>& S_A);
+
+// UTF-8 encoding of one Unicode scalar value
+std::string EncodeUtf8(char32_t code_point);
+
+#endif // UTF8_ALPHABET_H
@@ -1,4 +1,6 @@
 #include "automaton.h"
+#include "parallel_for.h"
+#include "table_export.h"
 #include <iostream>
 #include <vector>
 #include <map> 
@@ -9,55 +11,257 @@ using std::map;
 using std::string;
 
 // 实现构造函数
-Automaton::Automaton(map<char, int> A, vector<vector<int>> M, vector<int> S_A) 
-    : state(0), initial_state(0), alphabet(A), transition_matrix(M), 
-      accepting_states(S_A), num_states(M.size()) 
+// 参数按值传入，直接移动到共享的定义中，不再复制
+Automaton::Automaton(map<char, int> A, vector<vector<int>> M, vector<int> S_A, Validation validation,
+                     TablePlacement placement)
+    : Automaton(ClassesOf(A, validation), std::move(M), std::move(S_A), validation, placement)
 {
-    // 验证输入
-    ValidateAlphabet(A);
-    ValidateTransitionMatrix(M, A.size());
-    ValidateAcceptingStates(S_A);
+}
+
+namespace {
+
+std::pmr::memory_resource* MemoryOf(const TablePlacement& placement)
+{
+    return placement.arena != nullptr ? placement.arena : std::pmr::get_default_resource();
+}
+
+// 构造过程中临时数组的总大小上界：展平的矩阵、接受标记，以及FindAbsorbingStates中的数组
+size_t ScratchBytes(size_t num_states, size_t num_columns)
+{
+    const size_t n = num_states;
+    const size_t bit_vector = (n / 64 + 1) * sizeof(uint64_t);
+    return 2 * n * num_columns * sizeof(uint32_t) + (n + 1 + 2 * n) * sizeof(size_t) + bit_vector +
+           8 * alignof(std::max_align_t);
+}
+
+// 小自动机的临时数组放在栈上的缓冲区里，既不占用竞技场也不访问堆；放不下时直接用memory
+class Scratch
+{
+public:
+    static constexpr size_t kStackBytes = 8192;
+
+    Scratch(size_t num_states, size_t num_columns, std::pmr::memory_resource* memory)
+        : on_stack(buffer, sizeof(buffer), memory),
+          resource(ScratchBytes(num_states, num_columns) <= sizeof(buffer) ? &on_stack : memory)
+    {
+    }
+
+    std::pmr::memory_resource* Get() { return resource; }
+
+private:
+    alignas(std::max_align_t) char buffer[kStackBytes];
+    std::pmr::monotonic_buffer_resource on_stack;
+    std::pmr::memory_resource* resource;
+};
+
+} // namespace
+
+// 字母表以字节类表的形式保存，运行时不再保留map
+Automaton::Automaton(ByteClasses A, vector<vector<int>> M, vector<int> S_A, Validation validation,
+                     TablePlacement placement)
+{
+    const bool validate = validation == Validation::Full;
+    std::pmr::memory_resource* memory = MemoryOf(placement);
+
+    // 定义连同shared_ptr的控制块一起从memory分配
+    auto d = std::allocate_shared<Definition>(std::pmr::polymorphic_allocator<Definition>(memory), memory);
+    d->alphabet = std::move(A);
+    d->num_states = M.size();
+
+    // 转移矩阵的验证与展平在同一遍中完成
+    Scratch scratch(M.size(), d->alphabet.NumColumns(), memory);
+    std::pmr::vector<uint32_t> flat = FlattenTransitionMatrix(M, d->alphabet.NumColumns(), validate, scratch.Get());
+    if (validate) {
+        ValidateAcceptingStates(S_A.data(), S_A.size(), M.size());
+    }
+    Build(*d, flat, AcceptingFlags(S_A.data(), S_A.size(), M.size(), scratch.Get()), placement, scratch.Get());
+
+    // 在堆上时保留传入的嵌套形式；在竞技场中则随参数一起释放，需要时再重建
+    if (placement.arena == nullptr) {
+        std::call_once(d->nested_once, [&] {
+            d->transition_matrix = std::move(M);
+            d->accepting_states = std::move(S_A);
+        });
+    }
+
+    def = std::move(d);
+    state = def->table.start;
+}
+
+Automaton::Automaton(const ByteClasses& A, size_t num_states, const int* transitions, const int* S_A,
+                     size_t num_accepting, Validation validation, TablePlacement placement)
+{
+    const bool validate = validation == Validation::Full;
+    std::pmr::memory_resource* memory = MemoryOf(placement);
+
+    auto d = std::allocate_shared<Definition>(std::pmr::polymorphic_allocator<Definition>(memory), memory);
+    d->alphabet = A;
+    d->num_states = num_states;
+
+    Scratch scratch(num_states, A.NumColumns(), memory);
+    std::pmr::vector<uint32_t> flat = FlattenTransitions(transitions, num_states, A.NumColumns(), validate,
+                                                         scratch.Get());
+    if (validate) {
+        ValidateAcceptingStates(S_A, num_accepting, num_states);
+    }
+    Build(*d, flat, AcceptingFlags(S_A, num_accepting, num_states, scratch.Get()), placement, scratch.Get());
+
+    def = std::move(d);
+    state = def->table.start;
+}
+
+void Automaton::Build(Definition& d, const std::pmr::vector<uint32_t>& flat, const std::pmr::vector<bool>& accepting,
+                      const TablePlacement& placement, std::pmr::memory_resource* scratch)
+{
+    FindAbsorbingStates(d, flat, accepting, scratch);
+    d.table = DfaTable::Compile(d.alphabet, flat.data(), accepting, d.absorbing, d.initial_state, placement);
+
+    // 每个节点的副本由绑定在该节点上的线程复制，首次写入使页面分配在本地内存
+    if (placement.numa_replicas && placement.arena == nullptr) {
+        NumaTopology topology = DetectNumaTopology();
+        if (topology.NumNodes() > 1) {
+            d.replicas.resize(topology.NumNodes());
+            RunOnEachNode(topology, [&](size_t node) {
+                d.replicas[node] = std::make_unique<const DfaTable>(d.table);
+            });
+            d.topology = std::move(topology);
+        }
+    }
+}
+
+// 从编译后的表重建嵌套的转移矩阵和接受状态列表
+const Automaton::Definition& Automaton::Definition::Nested() const
+{
+    std::call_once(nested_once, [this] {
+        const size_t num_columns = alphabet.NumColumns();
+        transition_matrix.assign(num_states, vector<int>(num_columns));
+        for (size_t s = 0; s < num_states; s++) {
+            const DfaTable::StateId row = table.row_of[s];
+            for (size_t col = 0; col < num_columns; col++) {
+                transition_matrix[s][col] = static_cast<int>(table.StateOf(table.next[row + col]));
+            }
+            if (table.IsAccepting(row)) {
+                accepting_states.push_back(static_cast<int>(s));
+            }
+        }
+    });
+    return *this;
+}
+
+// 与定义中从竞技场分配的各个数组一一对应，每次分配再留出对齐的余量
+size_t Automaton::ArenaBytes(size_t num_states, size_t num_columns)
+{
+    const size_t n = num_states;
+    const size_t rows = n + 1;
+    const size_t bit_vector = (n / 64 + 1) * sizeof(uint64_t);
+    size_t bytes = sizeof(Definition) + 128;                        // 定义和shared_ptr的控制块
+    bytes += 2 * bit_vector;                                         // live，absorbing
+    bytes += n * sizeof(DfaTable::StateId);                          // row_of
+    bytes += rows * (sizeof(uint32_t) + sizeof(uint8_t));            // state_of，accepting
+    bytes += rows * (num_columns + 1) * sizeof(DfaTable::StateId);   // next
+    if (ScratchBytes(num_states, num_columns) > Scratch::kStackBytes) {
+        bytes += ScratchBytes(num_states, num_columns);
+    }
+    return bytes + 8 * alignof(std::max_align_t);
 }
 
 // 实现Read方法
-bool Automaton::Read(string word, bool reset)
+bool Automaton::Read(const string& word, bool reset)
 {
+    const DfaTable& table = def->LocalTable();
     if (reset) {
-        state = initial_state;
+        state = table.start;
     }
-    
-    for(auto &c : word)
-    {
-        auto it = alphabet.find(c);
-        if (it == alphabet.end()) {
-            // 创建一个建议字符串，使用remove_if和erase移除所有无效字符
-            string suggestion = word;
-            suggestion.erase(
-                std::remove_if(suggestion.begin(), suggestion.end(), 
-                    [this](char ch) { 
-                        return this->alphabet.find(ch) == this->alphabet.end(); 
-                    }),
-                suggestion.end()
-            );
-            
-            string error_msg = "Invalid input symbol: '" + string(1, c) + "'";
-            if (!suggestion.empty()) {
-                error_msg += ". Suggestion: Try '" + suggestion + "' instead";
-            } else {
-                error_msg += ". No valid characters found in input";
+
+    // 编译后的表在进入死状态、接受汇点或遇到无效符号时提前停止
+    const DfaTable::StateId start = state;
+    const char* stop = table.Run(state, word.data(), word.data() + word.size());
+
+    if (state == DfaTable::kInvalidRow) {
+        char c = *(stop - 1);
+        // 恢复到无效符号之前的状态
+        state = start;
+        table.Run(state, word.data(), stop - 1);
+
+        // 创建一个建议字符串，使用remove_if和erase移除所有无效字符
+        string suggestion = word;
+        suggestion.erase(
+            std::remove_if(suggestion.begin(), suggestion.end(), 
+                [this](char ch) { 
+                    return !this->def->alphabet.Contains(ch); 
+                }),
+            suggestion.end()
+        );
+        
+        string error_msg = "Invalid input symbol: '" + string(1, c) + "'";
+        if (!suggestion.empty()) {
+            error_msg += ". Suggestion: Try '" + suggestion + "' instead";
+        } else {
+            error_msg += ". No valid characters found in input";
+        }
+        
+        throw std::invalid_argument(error_msg);
+    }
+
+    return table.IsAccepting(state);
+}
+
+// 标记死状态（无法到达接受状态）和接受汇点（无法离开接受状态）
+void Automaton::FindAbsorbingStates(Definition& d, const std::pmr::vector<uint32_t>& flat,
+                                    const std::pmr::vector<bool>& accepting, std::pmr::memory_resource* scratch) {
+    size_t n = d.num_states;
+    size_t num_columns = d.alphabet.NumColumns();
+    // 前驱表以CSR形式存放：predecessors[offsets[q], offsets[q+1]) 为 q 的所有前驱
+    std::pmr::vector<size_t> offsets(n + 1, 0, scratch);
+    for (uint32_t target : flat) {
+        offsets[target + 1]++;
+    }
+    for (size_t q = 0; q < n; q++) {
+        offsets[q + 1] += offsets[q];
+    }
+    std::pmr::vector<uint32_t> predecessors(flat.size(), scratch);
+    std::pmr::vector<size_t> fill(offsets.begin(), offsets.end() - 1, scratch);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t col = 0; col < num_columns; col++) {
+            predecessors[fill[flat[i * num_columns + col]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // 从接受状态出发沿反向边搜索，得到能到达接受状态的所有状态
+    d.live.assign(n, false);
+    std::pmr::vector<size_t> stack(scratch);
+    stack.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (accepting[i]) {
+            d.live[i] = true;
+            stack.push_back(i);
+        }
+    }
+    while (!stack.empty()) {
+        size_t q = stack.back();
+        stack.pop_back();
+        for (size_t k = offsets[q]; k < offsets[q + 1]; k++) {
+            size_t p = predecessors[k];
+            if (!d.live[p]) {
+                d.live[p] = true;
+                stack.push_back(p);
             }
-            
-            throw std::invalid_argument(error_msg);
         }
-        size_t j = static_cast<size_t>(it->second);
-        state = transition_matrix[static_cast<size_t>(state)][j];
     }
-    
-    return std::find(accepting_states.begin(), accepting_states.end(), state) != accepting_states.end();
+
+    // 只有所有转移都回到自身的汇点才能提前停止：此后状态不再改变，停下时的状态仍然准确
+    d.absorbing.assign(n, false);
+    for (size_t i = 0; i < n; i++) {
+        bool sink = true;
+        for (size_t col = 0; col < num_columns && sink; col++) {
+            sink = flat[i * num_columns + col] == i;
+        }
+        d.absorbing[i] = sink;
+    }
 }
 
 void Automaton::Reset() {
-    state = initial_state;
+    state = def->table.start;
 }
 
 // 实现ValidateAlphabet方法
@@ -66,36 +270,90 @@ void Automaton::ValidateAlphabet(const map<char, int>& A) {
         if(pair.second < 0) {
             throw std::invalid_argument("Alphabet values must be non-negative integers.");
         }
+        if(static_cast<size_t>(pair.second) >= A.size()) {
+            throw std::invalid_argument("Alphabet values must be smaller than the alphabet size.");
+        }
     }
 }
 
-// 实现ValidateTransitionMatrix方法
-void Automaton::ValidateTransitionMatrix(const vector<vector<int>>& M, size_t alphabet_size) {
+ByteClasses Automaton::ClassesOf(const map<char, int>& A, Validation validation) {
+    if (validation == Validation::Full) {
+        ValidateAlphabet(A);
+    }
+    return ByteClasses::FromMap(A);
+}
+
+// 验证转移矩阵并展平为连续数组；大矩阵按行区间并行处理
+std::pmr::vector<uint32_t> Automaton::FlattenTransitionMatrix(const vector<vector<int>>& M, size_t num_columns,
+                                                              bool validate, std::pmr::memory_resource* memory) {
     // 确保矩阵不为空
-    if (M.empty()) {
+    if (validate && M.empty()) {
         throw std::invalid_argument("Transition matrix cannot be empty");
     }
-    
-    // 检查每个状态对每个字母表符号都有转移
-    for (size_t i = 0; i < M.size(); i++) {
-        if (M[i].size() != alphabet_size) {
-            throw std::invalid_argument("Each state must have a transition for each alphabet symbol");
-        }
-        
-        // 检查每个转移都指向有效状态
-        for (size_t j = 0; j < M[i].size(); j++) {
-            if (M[i][j] < 0 || M[i][j] >= static_cast<int>(M.size())) {
-                throw std::invalid_argument("Transition to invalid state: " + 
-                    std::to_string(M[i][j]) + " from state " + std::to_string(i));
+
+    std::pmr::vector<uint32_t> flat(M.size() * num_columns, memory);
+    ParallelFor(M.size(), 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            // 检查每个状态对每个字母表符号都有转移
+            if (validate && M[i].size() != num_columns) {
+                throw std::invalid_argument("Each state must have a transition for each alphabet symbol");
             }
+            CopyRow(M[i].data(), num_columns, M.size(), i, validate, flat.data() + i * num_columns);
         }
+    });
+    return flat;
+}
+
+std::pmr::vector<uint32_t> Automaton::FlattenTransitions(const int* transitions, size_t num_states,
+                                                         size_t num_columns, bool validate,
+                                                         std::pmr::memory_resource* memory) {
+    if (validate && num_states == 0) {
+        throw std::invalid_argument("Transition matrix cannot be empty");
+    }
+
+    std::pmr::vector<uint32_t> flat(num_states * num_columns, memory);
+    ParallelFor(num_states, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            CopyRow(transitions + i * num_columns, num_columns, num_states, i, validate,
+                    flat.data() + i * num_columns);
+        }
+    });
+    return flat;
+}
+
+void Automaton::CopyRow(const int* row, size_t num_columns, size_t num_states, size_t state, bool validate,
+                        uint32_t* out) {
+    if (!validate) {
+        for (size_t j = 0; j < num_columns; j++) {
+            out[j] = static_cast<uint32_t>(row[j]);
+        }
+        return;
+    }
+
+    // 检查每个转移都指向有效状态
+    for (size_t j = 0; j < num_columns; j++) {
+        if (row[j] < 0 || static_cast<size_t>(row[j]) >= num_states) {
+            throw std::invalid_argument("Transition to invalid state: " +
+                std::to_string(row[j]) + " from state " + std::to_string(state));
+        }
+        out[j] = static_cast<uint32_t>(row[j]);
     }
 }
 
+std::pmr::vector<bool> Automaton::AcceptingFlags(const int* S_A, size_t num_accepting, size_t num_states,
+                                                 std::pmr::memory_resource* memory) {
+    std::pmr::vector<bool> accepting(num_states, false, memory);
+    for (size_t i = 0; i < num_accepting; i++) {
+        accepting[static_cast<size_t>(S_A[i])] = true;
+    }
+    return accepting;
+}
+
 // 实现ValidateAcceptingStates方法
-void Automaton::ValidateAcceptingStates(const vector<int>& S_A) {
-    for (auto& state : S_A) {
-        if (state < 0 || state >= num_states) {
+void Automaton::ValidateAcceptingStates(const int* S_A, size_t num_accepting, size_t num_states) {
+    for (size_t i = 0; i < num_accepting; i++) {
+        const int state = S_A[i];
+        if (state < 0 || static_cast<size_t>(state) >= num_states) {
             throw std::invalid_argument("Accepting state " + std::to_string(state) + 
                 " is outside valid range [0, " + std::to_string(num_states-1) + "]");
         }
@@ -103,46 +361,17 @@ void Automaton::ValidateAcceptingStates(const vector<int>& S_A) {
 }
 
 void Automaton::PrintCurrentState() const {
-    std::cout << "Current state: " << state;
-    if (std::find(accepting_states.begin(), accepting_states.end(), state) != accepting_states.end()) {
+    std::cout << "Current state: " << def->table.StateOf(state);
+    if (def->table.IsAccepting(state)) {
         std::cout << " (accepting)";
     }
     std::cout << std::endl;
 }
 
 bool Automaton::IsInAcceptingState() const {
-    return std::find(accepting_states.begin(), accepting_states.end(), state) != accepting_states.end();
+    return def->table.IsAccepting(state);
 }
 
 void Automaton::PrintTransitionTable() const {
-    std::cout << "Transition Table:" << std::endl;
-    std::cout << "----------------" << std::endl;
-    
-    // 打印列标题（输入符号）
-    std::cout << "State |";
-    for (const auto& pair : alphabet) {
-        std::cout << " '" << pair.first << "' |";
-    }
-    std::cout << std::endl;
-    
-    // 打印分隔线
-    std::cout << "------|";
-    for (size_t i = 0; i < alphabet.size(); i++) {
-        std::cout << "-----|";
-    }
-    std::cout << std::endl;
-    
-    // 打印每个状态的转移
-    for (size_t i = 0; i < transition_matrix.size(); i++) {
-        std::cout << "  " << i << "   |";
-        for (size_t j = 0; j < transition_matrix[i].size(); j++) {
-            std::cout << "  " << transition_matrix[i][j] << "  |";
-        }
-        
-        // 标记接受状态
-        if (std::find(accepting_states.begin(), accepting_states.end(), i) != accepting_states.end()) {
-            std::cout << " (accepting)";
-        }
-        std::cout << std::endl;
-    }
-}   
+    ExportTable(*this, std::cout, TableFormat::Text);
+}
@@ -0,0 +1,272 @@
+#include "automaton_io.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+const char kBinaryMagic[4] = {'D', 'F', 'A', 'B'};
+// Version 1 stored (symbol, column) pairs; version 2 stores the byte -> column table
+const uint32_t kBinaryVersion = 2;
+
+uint64_t Fnv1a(const uint8_t* data, size_t n)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < n; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template <typename T>
+void Put(vector<uint8_t>& out, T value)
+{
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Reads fixed-size values from the image, refusing to run past its end
+class ImageReader
+{
+public:
+    ImageReader(const vector<uint8_t>& data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    T Get()
+    {
+        if (sizeof(T) > size - pos) {
+            throw std::invalid_argument("Binary DFA image is truncated");
+        }
+        T value;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    size_t Remaining() const { return size - pos; }
+
+private:
+    const vector<uint8_t>& data;
+    size_t size;
+    size_t pos = 0;
+};
+
+} // namespace
+
+Automaton LoadAutomaton(std::istream& in)
+{
+    map<char, int> alphabet;
+    vector<string> classes;
+    vector<int> accepting;
+    vector<vector<int>> M;
+    bool have_alphabet = false;
+    bool have_classes = false;
+    bool have_accepting = false;
+
+    string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        if (line.compare(0, 9, "alphabet ") == 0) {
+            string symbols = line.substr(9);
+            for (size_t i = 0; i < symbols.size(); i++) {
+                if (!alphabet.emplace(symbols[i], static_cast<int>(i)).second) {
+                    throw std::invalid_argument("Duplicate alphabet symbol on line " + std::to_string(line_number));
+                }
+            }
+            have_alphabet = true;
+            continue;
+        }
+        if (line.compare(0, 8, "classes ") == 0) {
+            std::istringstream specs(line.substr(8));
+            string spec;
+            while (specs >> spec) {
+                classes.push_back(spec);
+            }
+            have_classes = true;
+            continue;
+        }
+
+        bool is_accepting = line.compare(0, 9, "accepting") == 0 && (line.size() == 9 || line[9] == ' ');
+        std::istringstream fields(is_accepting ? line.substr(9) : line);
+        vector<int> values;
+        int value;
+        while (fields >> value) {
+            values.push_back(value);
+        }
+        if (!fields.eof()) {
+            throw std::invalid_argument("Malformed DFA definition on line " + std::to_string(line_number));
+        }
+        if (is_accepting) {
+            accepting = std::move(values);
+            have_accepting = true;
+        } else {
+            M.push_back(std::move(values));
+        }
+    }
+
+    if (have_alphabet == have_classes || !have_accepting) {
+        throw std::invalid_argument("DFA definition needs an 'alphabet' or a 'classes' line and an 'accepting' line");
+    }
+    if (have_classes) {
+        return Automaton(ByteClasses::Parse(classes), std::move(M), std::move(accepting));
+    }
+    return Automaton(std::move(alphabet), std::move(M), std::move(accepting));
+}
+
+Automaton LoadAutomatonFile(const string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open DFA file: " + path);
+    }
+    return LoadAutomaton(in);
+}
+
+void SaveAutomaton(std::ostream& out, const Automaton& dfa)
+{
+    // 每列恰好一个字符时使用alphabet行，否则按字符类写出
+    const ByteClasses& alphabet = dfa.GetByteClasses();
+    string symbols;
+    bool one_per_column = true;
+    for (size_t col = 0; col < alphabet.NumColumns() && one_per_column; col++) {
+        string column = alphabet.Symbols(col);
+        one_per_column = column.size() == 1;
+        symbols += column;
+    }
+
+    string text;
+    if (one_per_column) {
+        text = "alphabet " + symbols;
+    } else {
+        text = "classes";
+        for (size_t col = 0; col < alphabet.NumColumns(); col++) {
+            text += ' ' + alphabet.Describe(col);
+        }
+    }
+    text += "\naccepting";
+    for (int s : dfa.GetAcceptingStates()) {
+        text += ' ' + std::to_string(s);
+    }
+    text += '\n';
+    for (const auto& row : dfa.GetTransitionMatrix()) {
+        for (size_t j = 0; j < row.size(); j++) {
+            if (j > 0) {
+                text += ' ';
+            }
+            text += std::to_string(row[j]);
+        }
+        text += '\n';
+    }
+    out << text;
+}
+
+void SaveAutomatonBinary(std::ostream& out, const Automaton& dfa)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    size_t num_columns = dfa.GetNumColumns();
+
+    vector<uint8_t> image(kBinaryMagic, kBinaryMagic + 4);
+    image.reserve(600 + M.size() * num_columns * sizeof(uint32_t));
+    Put(image, kBinaryVersion);
+    Put(image, static_cast<uint32_t>(num_columns));
+    for (uint16_t col : dfa.GetByteClasses().Table()) {
+        Put(image, col);
+    }
+    Put(image, static_cast<uint32_t>(M.size()));
+    Put(image, static_cast<uint32_t>(dfa.GetAcceptingStates().size()));
+    for (int s : dfa.GetAcceptingStates()) {
+        Put(image, static_cast<uint32_t>(s));
+    }
+    for (const auto& row : M) {
+        for (int target : row) {
+            Put(image, static_cast<uint32_t>(target));
+        }
+    }
+    Put(image, Fnv1a(image.data(), image.size()));
+    out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+}
+
+Automaton LoadAutomatonBinary(std::istream& in)
+{
+    vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (image.size() < sizeof(kBinaryMagic) + sizeof(uint32_t) + sizeof(uint64_t) ||
+        std::memcmp(image.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw std::invalid_argument("Not a binary DFA image");
+    }
+
+    size_t payload = image.size() - sizeof(uint64_t);
+    uint64_t checksum;
+    std::memcpy(&checksum, image.data() + payload, sizeof(checksum));
+    if (checksum != Fnv1a(image.data(), payload)) {
+        throw std::invalid_argument("Binary DFA image checksum mismatch");
+    }
+
+    ImageReader reader(image, payload);
+    reader.Get<uint32_t>();  // magic
+    uint32_t version = reader.Get<uint32_t>();
+    if (version != 1 && version != kBinaryVersion) {
+        throw std::invalid_argument("Unsupported binary DFA image version");
+    }
+
+    uint32_t num_columns = reader.Get<uint32_t>();
+    ByteClasses alphabet;
+    if (version == 1) {
+        // 每列对应一个字节，超过 256 列的映像不可能合法
+        if (num_columns > 256) {
+            throw std::invalid_argument("Binary DFA image has too many columns");
+        }
+        map<char, int> pairs;
+        for (uint32_t i = 0; i < num_columns; i++) {
+            char symbol = reader.Get<char>();
+            pairs[symbol] = static_cast<int>(reader.Get<uint32_t>());
+        }
+        alphabet = ByteClasses::FromMap(pairs);
+    } else {
+        std::array<uint16_t, 256> column_of;
+        for (uint16_t& col : column_of) {
+            col = reader.Get<uint16_t>();
+        }
+        alphabet = ByteClasses::FromTable(column_of, num_columns);
+    }
+
+    uint32_t num_states = reader.Get<uint32_t>();
+    // 先按剩余长度检查计数，再分配
+    uint32_t num_accepting = reader.Get<uint32_t>();
+    if (num_accepting > reader.Remaining() / sizeof(uint32_t)) {
+        throw std::invalid_argument("Binary DFA image is truncated");
+    }
+    vector<int> accepting(num_accepting);
+    for (int& s : accepting) {
+        s = static_cast<int>(reader.Get<uint32_t>());
+    }
+
+    if (reader.Remaining() / sizeof(uint32_t) / std::max<size_t>(num_columns, 1) < num_states) {
+        throw std::invalid_argument("Binary DFA image is truncated");
+    }
+    vector<vector<int>> M(num_states, vector<int>(num_columns));
+    for (auto& row : M) {
+        for (int& target : row) {
+            target = static_cast<int>(reader.Get<uint32_t>());
+        }
+    }
+
+    return Automaton(std::move(alphabet), std::move(M), std::move(accepting), Validation::Trusted);
+}
@@ -0,0 +1,55 @@
+#include "buffered_writer.h"
+#include <cstring>
+#include <stdexcept>
+
+BufferedWriter::BufferedWriter(std::ostream& out, size_t capacity)
+    : stream(&out), buffer(capacity > 0 ? capacity : 1)
+{
+}
+
+BufferedWriter::BufferedWriter(std::FILE* f, size_t capacity)
+    : file(f), buffer(capacity > 0 ? capacity : 1)
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    try {
+        Flush();
+    } catch (...) {
+        // 析构函数不能抛出异常；需要检查错误的调用者应先显式调用Flush
+    }
+}
+
+void BufferedWriter::Write(std::string_view text)
+{
+    if (text.size() > buffer.size() - used) {
+        Flush();
+        if (text.size() >= buffer.size()) {
+            // 大块数据直接写出，不经过缓冲区
+            WriteOut(text.data(), text.size());
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void BufferedWriter::Flush()
+{
+    size_t n = used;
+    used = 0;
+    WriteOut(buffer.data(), n);
+}
+
+void BufferedWriter::WriteOut(const char* data, size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+    if (stream) {
+        stream->write(data, static_cast<std::streamsize>(n));
+    } else if (std::fwrite(data, 1, n, file) != n) {
+        throw std::runtime_error("Write to file failed");
+    }
+}
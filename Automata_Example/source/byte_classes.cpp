@@ -0,0 +1,221 @@
+#include "byte_classes.h"
+#include <stdexcept>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Reads one possibly escaped character of a class starting at spec[pos]
+unsigned char ReadClassChar(const string& spec, size_t& pos, size_t end)
+{
+    char c = spec[pos++];
+    if (c != '\\') {
+        return static_cast<unsigned char>(c);
+    }
+    if (pos >= end) {
+        throw std::invalid_argument("Dangling escape in alphabet class \"" + spec + "\"");
+    }
+    c = spec[pos++];
+    switch (c) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case '0': return 0;
+    case 'x': {
+        int high = pos < end ? HexDigit(spec[pos]) : -1;
+        int low = pos + 1 < end ? HexDigit(spec[pos + 1]) : -1;
+        if (high < 0 || low < 0) {
+            throw std::invalid_argument("Bad \\x escape in alphabet class \"" + spec + "\"");
+        }
+        pos += 2;
+        return static_cast<unsigned char>(high * 16 + low);
+    }
+    default:
+        return static_cast<unsigned char>(c);
+    }
+}
+
+// Bytes named by one class specification
+std::array<bool, 256> ParseClass(const string& spec)
+{
+    std::array<bool, 256> members{};
+    if (spec.size() < 2 || spec.front() != '[' || spec.back() != ']') {
+        for (char c : spec) {
+            members[static_cast<unsigned char>(c)] = true;
+        }
+        return members;
+    }
+
+    size_t pos = 1;
+    const size_t end = spec.size() - 1;
+    bool negate = pos < end && spec[pos] == '^';
+    if (negate) {
+        pos++;
+    }
+    while (pos < end) {
+        unsigned char first = ReadClassChar(spec, pos, end);
+        unsigned char last = first;
+        if (pos + 1 < end && spec[pos] == '-') {
+            pos++;
+            last = ReadClassChar(spec, pos, end);
+            if (last < first) {
+                throw std::invalid_argument("Reversed range in alphabet class \"" + spec + "\"");
+            }
+        }
+        for (unsigned b = first; b <= last; b++) {
+            members[b] = true;
+        }
+    }
+    if (negate) {
+        for (bool& member : members) {
+            member = !member;
+        }
+    }
+    return members;
+}
+
+void AppendClassChar(string& out, unsigned char byte)
+{
+    static const char hex[] = "0123456789abcdef";
+    if (byte == '\\' || byte == ']' || byte == '[' || byte == '-' || byte == '^') {
+        out += '\\';
+        out += static_cast<char>(byte);
+    } else if (byte <= 0x20 || byte >= 0x7f) {
+        out += "\\x";
+        out += hex[byte >> 4];
+        out += hex[byte & 0xf];
+    } else {
+        out += static_cast<char>(byte);
+    }
+}
+
+} // namespace
+
+ByteClasses ByteClasses::Parse(const vector<string>& classes)
+{
+    if (classes.size() >= kNoColumn) {
+        throw std::invalid_argument("Too many alphabet classes");
+    }
+    ByteClasses result;
+    result.num_columns = classes.size();
+    for (size_t col = 0; col < classes.size(); col++) {
+        std::array<bool, 256> members = ParseClass(classes[col]);
+        bool empty = true;
+        for (unsigned b = 0; b < 256; b++) {
+            if (!members[b]) {
+                continue;
+            }
+            if (result.column_of[b] != kNoColumn) {
+                string name;
+                AppendClassChar(name, static_cast<unsigned char>(b));
+                throw std::invalid_argument("Character '" + name + "' appears in more than one alphabet class");
+            }
+            result.column_of[b] = static_cast<std::uint16_t>(col);
+            empty = false;
+        }
+        // "[]"是Describe给未使用的列写出的形式，其他写法得到空类视为错误
+        if (empty && classes[col] != "[]") {
+            throw std::invalid_argument("Alphabet class \"" + classes[col] + "\" is empty");
+        }
+    }
+    return result;
+}
+
+ByteClasses ByteClasses::FromMap(const std::map<char, int>& alphabet)
+{
+    ByteClasses result;
+    result.num_columns = alphabet.size();
+    for (const auto& pair : alphabet) {
+        result.column_of[static_cast<unsigned char>(pair.first)] = static_cast<std::uint16_t>(pair.second);
+    }
+    return result;
+}
+
+ByteClasses ByteClasses::FromTable(const std::array<std::uint16_t, 256>& column_of, std::size_t num_columns)
+{
+    if (num_columns >= kNoColumn) {
+        throw std::invalid_argument("Too many alphabet columns");
+    }
+    for (std::uint16_t col : column_of) {
+        if (col != kNoColumn && col >= num_columns) {
+            throw std::invalid_argument("Byte class table refers to column " + std::to_string(col) +
+                " of " + std::to_string(num_columns));
+        }
+    }
+    ByteClasses result;
+    result.column_of = column_of;
+    result.num_columns = num_columns;
+    return result;
+}
+
+std::size_t ByteClasses::NumSymbols() const
+{
+    std::size_t n = 0;
+    for (std::uint16_t col : column_of) {
+        n += col != kNoColumn;
+    }
+    return n;
+}
+
+string ByteClasses::Symbols(std::size_t column) const
+{
+    string symbols;
+    for (unsigned b = 0; b < 256; b++) {
+        if (column_of[b] == column) {
+            symbols += static_cast<char>(b);
+        }
+    }
+    return symbols;
+}
+
+string ByteClasses::Describe(std::size_t column) const
+{
+    // Runs of three or more consecutive bytes are written as ranges
+    string out = "[";
+    unsigned b = 0;
+    while (b < 256) {
+        if (column_of[b] != column) {
+            b++;
+            continue;
+        }
+        unsigned last = b;
+        while (last + 1 < 256 && column_of[last + 1] == column) {
+            last++;
+        }
+        AppendClassChar(out, static_cast<unsigned char>(b));
+        if (last >= b + 2) {
+            out += '-';
+            AppendClassChar(out, static_cast<unsigned char>(last));
+        } else if (last == b + 1) {
+            AppendClassChar(out, static_cast<unsigned char>(last));
+        }
+        b = last + 1;
+    }
+    return out + "]";
+}
+
+std::map<char, int> ByteClasses::ToMap() const
+{
+    std::map<char, int> alphabet;
+    for (unsigned b = 0; b < 256; b++) {
+        if (column_of[b] != kNoColumn) {
+            alphabet[static_cast<char>(b)] = column_of[b];
+        }
+    }
+    return alphabet;
+}
@@ -0,0 +1,425 @@
+#include "counting.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+
+using std::vector;
+
+BigCount::BigCount(uint64_t value)
+{
+    if (value != 0) {
+        limbs.push_back(static_cast<uint32_t>(value));
+        if ((value >> 32) != 0) {
+            limbs.push_back(static_cast<uint32_t>(value >> 32));
+        }
+    }
+}
+
+void BigCount::AddMultiple(const BigCount& x, uint32_t factor)
+{
+    if (factor == 0 || x.limbs.empty()) {
+        return;
+    }
+    if (limbs.size() < x.limbs.size()) {
+        limbs.resize(x.limbs.size(), 0);
+    }
+    // limb + x * factor + carry never exceeds 2^64 - 1
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < x.limbs.size(); i++) {
+        uint64_t cur = limbs[i] + static_cast<uint64_t>(x.limbs[i]) * factor + carry;
+        limbs[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    for (; carry != 0; i++) {
+        if (i == limbs.size()) {
+            limbs.push_back(0);
+        }
+        uint64_t cur = limbs[i] + carry;
+        limbs[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+}
+
+uint64_t BigCount::Mod(uint64_t modulus) const
+{
+    if (modulus == 0) {
+        throw std::invalid_argument("Modulus must be non-zero");
+    }
+    unsigned __int128 r = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        r = ((r << 32) | limbs[i]) % modulus;
+    }
+    return static_cast<uint64_t>(r);
+}
+
+std::string BigCount::ToString() const
+{
+    if (limbs.empty()) {
+        return "0";
+    }
+    // Peel off base-10^9 digits from the least significant end
+    constexpr uint32_t kChunk = 1000000000;
+    vector<uint32_t> rest = limbs;
+    vector<uint32_t> chunks;
+    while (!rest.empty()) {
+        uint64_t rem = 0;
+        for (size_t i = rest.size(); i-- > 0;) {
+            uint64_t cur = (rem << 32) | rest[i];
+            rest[i] = static_cast<uint32_t>(cur / kChunk);
+            rem = cur % kChunk;
+        }
+        chunks.push_back(static_cast<uint32_t>(rem));
+        while (!rest.empty() && rest.back() == 0) {
+            rest.pop_back();
+        }
+    }
+
+    std::string out = std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        std::string digits = std::to_string(chunks[i]);
+        out.append(9 - digits.size(), '0');
+        out += digits;
+    }
+    return out;
+}
+
+namespace {
+
+// The automaton reduced to the states reachable from its initial state (which
+// becomes state 0), with parallel edges merged: from state q the characters
+// symbols[symbol_offset[e] .. symbol_offset[e + 1]) lead to target[e], for e in
+// [offset[q], offset[q + 1]), and weight[e] is how many there are.
+struct CountGraph
+{
+    size_t num_states = 0;
+    vector<size_t> offset;
+    vector<uint32_t> target;
+    vector<uint32_t> weight;
+    vector<size_t> symbol_offset;
+    std::string symbols;
+    vector<bool> accepting;
+};
+
+CountGraph BuildCountGraph(const Automaton& dfa)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    const auto& alphabet = dfa.GetAlphabet();
+
+    vector<uint32_t> index(M.size(), UINT32_MAX);
+    vector<size_t> order;
+    std::deque<size_t> queue;
+    size_t initial = static_cast<size_t>(dfa.GetInitialState());
+    index[initial] = 0;
+    order.push_back(initial);
+    queue.push_back(initial);
+    while (!queue.empty()) {
+        size_t q = queue.front();
+        queue.pop_front();
+        for (const auto& pair : alphabet) {
+            size_t t = static_cast<size_t>(M[q][static_cast<size_t>(pair.second)]);
+            if (index[t] == UINT32_MAX) {
+                index[t] = static_cast<uint32_t>(order.size());
+                order.push_back(t);
+                queue.push_back(t);
+            }
+        }
+    }
+
+    CountGraph graph;
+    graph.num_states = order.size();
+    graph.accepting.assign(order.size(), false);
+    for (int s : dfa.GetAcceptingStates()) {
+        uint32_t i = index[static_cast<size_t>(s)];
+        if (i != UINT32_MAX) {
+            graph.accepting[i] = true;
+        }
+    }
+
+    graph.offset.reserve(order.size() + 1);
+    graph.offset.push_back(0);
+    graph.symbol_offset.push_back(0);
+    vector<std::pair<uint32_t, char>> edges;
+    for (size_t q : order) {
+        edges.clear();
+        for (const auto& pair : alphabet) {
+            edges.emplace_back(index[static_cast<size_t>(M[q][static_cast<size_t>(pair.second)])], pair.first);
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t e = 0; e < edges.size(); e++) {
+            if (e > 0 && edges[e].first == edges[e - 1].first) {
+                graph.weight.back()++;
+                graph.symbol_offset.back()++;
+            } else {
+                graph.target.push_back(edges[e].first);
+                graph.weight.push_back(1);
+                graph.symbol_offset.push_back(graph.symbol_offset.back() + 1);
+            }
+            graph.symbols += edges[e].second;
+        }
+        graph.offset.push_back(graph.target.size());
+    }
+    return graph;
+}
+
+uint64_t MulMod(uint64_t a, uint64_t b, uint64_t m)
+{
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+}
+
+uint64_t AddMod(uint64_t a, uint64_t b, uint64_t m)
+{
+    // a, b < m; compare before adding so nothing wraps
+    return a >= m - b ? a - (m - b) : a + b;
+}
+
+// f_0[q] = [q accepting], f_{n+1}[q] = sum over edges q -> t of weight * f_n[t];
+// the answer is f_length[0]
+uint64_t CountByStepsMod(const CountGraph& g, uint64_t length, uint64_t m)
+{
+    vector<uint64_t> f(g.num_states), next(g.num_states);
+    for (size_t q = 0; q < g.num_states; q++) {
+        f[q] = g.accepting[q] ? 1 % m : 0;
+    }
+    for (uint64_t step = 0; step < length; step++) {
+        for (size_t q = 0; q < g.num_states; q++) {
+            uint64_t sum = 0;
+            for (size_t e = g.offset[q]; e < g.offset[q + 1]; e++) {
+                sum = AddMod(sum, MulMod(g.weight[e] % m, f[g.target[e]], m), m);
+            }
+            next[q] = sum;
+        }
+        f.swap(next);
+    }
+    return f[0];
+}
+
+// Dense n x n matrix over Z/m, row-major
+using Matrix = vector<uint64_t>;
+
+// c = a * b. Rows are split across threads; within a row the products are
+// accumulated in 128 bits and reduced once per entry. When m <= 2^32 every
+// product fits in 64 bits and a row of n < 2^64 of them cannot overflow, so
+// only moduli above that need a reduction per product.
+void Multiply(const Matrix& a, const Matrix& b, Matrix& c, size_t n, uint64_t m)
+{
+    const bool small_modulus = m <= (uint64_t{1} << 32);
+    size_t min_rows = std::max<size_t>(1, (size_t{1} << 16) / std::max<size_t>(1, n * n));
+    ParallelFor(n, min_rows, [&](size_t begin, size_t end) {
+        vector<unsigned __int128> acc(n);
+        for (size_t i = begin; i < end; i++) {
+            std::fill(acc.begin(), acc.end(), 0);
+            for (size_t k = 0; k < n; k++) {
+                uint64_t x = a[i * n + k];
+                if (x == 0) {
+                    continue;
+                }
+                const uint64_t* row = &b[k * n];
+                if (small_modulus) {
+                    for (size_t j = 0; j < n; j++) {
+                        acc[j] += static_cast<unsigned __int128>(x) * row[j];
+                    }
+                } else {
+                    for (size_t j = 0; j < n; j++) {
+                        acc[j] += static_cast<unsigned __int128>(x) * row[j] % m;
+                    }
+                }
+            }
+            for (size_t j = 0; j < n; j++) {
+                c[i * n + j] = static_cast<uint64_t>(acc[j] % m);
+            }
+        }
+    });
+}
+
+// A^length applied to the accepting vector, by repeated squaring of A
+uint64_t CountByPowerMod(const CountGraph& g, uint64_t length, uint64_t m)
+{
+    const size_t n = g.num_states;
+    Matrix power(n * n, 0), scratch(n * n);
+    for (size_t q = 0; q < n; q++) {
+        for (size_t e = g.offset[q]; e < g.offset[q + 1]; e++) {
+            power[q * n + g.target[e]] = g.weight[e] % m;
+        }
+    }
+    vector<uint64_t> v(n), w(n);
+    for (size_t q = 0; q < n; q++) {
+        v[q] = g.accepting[q] ? 1 % m : 0;
+    }
+
+    while (true) {
+        if ((length & 1) != 0) {
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = 0;
+                for (size_t j = 0; j < n; j++) {
+                    sum = AddMod(sum, MulMod(power[i * n + j], v[j], m), m);
+                }
+                w[i] = sum;
+            }
+            v.swap(w);
+        }
+        length >>= 1;
+        if (length == 0) {
+            break;
+        }
+        Multiply(power, power, scratch, n, m);
+        power.swap(scratch);
+    }
+    return v[0];
+}
+
+} // namespace
+
+BigCount CountAcceptedWords(const Automaton& dfa, size_t length)
+{
+    CountGraph g = BuildCountGraph(dfa);
+    vector<BigCount> f(g.num_states), next(g.num_states);
+    for (size_t q = 0; q < g.num_states; q++) {
+        f[q] = BigCount(g.accepting[q] ? 1 : 0);
+    }
+    for (size_t step = 0; step < length; step++) {
+        for (size_t q = 0; q < g.num_states; q++) {
+            BigCount sum;
+            for (size_t e = g.offset[q]; e < g.offset[q + 1]; e++) {
+                sum.AddMultiple(f[g.target[e]], g.weight[e]);
+            }
+            next[q] = std::move(sum);
+        }
+        f.swap(next);
+    }
+    return f[0];
+}
+
+uint64_t CountAcceptedWordsMod(const Automaton& dfa, uint64_t length, uint64_t modulus)
+{
+    if (modulus == 0) {
+        throw std::invalid_argument("Modulus must be non-zero");
+    }
+    CountGraph g = BuildCountGraph(dfa);
+
+    // Step-by-step costs length * edges, squaring about log2(length) * n^3
+    double n = static_cast<double>(g.num_states);
+    double steps_cost = static_cast<double>(length) * static_cast<double>(g.target.size());
+    double power_cost = std::log2(static_cast<double>(length) + 1) * n * n * n;
+    if (steps_cost <= power_cost) {
+        return CountByStepsMod(g, length, modulus);
+    }
+    return CountByPowerMod(g, length, modulus);
+}
+
+WordSampler::WordSampler(const Automaton& dfa, size_t max_length)
+    : max_length(max_length)
+{
+    CountGraph g = BuildCountGraph(dfa);
+    offset = std::move(g.offset);
+    target = std::move(g.target);
+    symbol_offset = std::move(g.symbol_offset);
+    symbols = std::move(g.symbols);
+
+    const size_t num_edges = target.size();
+    vector<double> completions(g.num_states), next(g.num_states);
+    for (size_t q = 0; q < g.num_states; q++) {
+        completions[q] = g.accepting[q] ? 1.0 : 0.0;
+    }
+    has_words.assign(max_length + 1, false);
+    has_words[0] = g.accepting[0];
+    cumulative.resize(max_length * num_edges);
+
+    for (size_t remaining = 1; remaining <= max_length; remaining++) {
+        double* cum = cumulative.data() + (remaining - 1) * num_edges;
+        double largest = 0;
+        for (size_t q = 0; q < g.num_states; q++) {
+            double sum = 0;
+            for (size_t e = offset[q]; e < offset[q + 1]; e++) {
+                sum += g.weight[e] * completions[target[e]];
+                cum[e] = sum;
+            }
+            next[q] = sum;
+            largest = std::max(largest, sum);
+        }
+        // Only ratios within one length matter, so rescaling keeps the
+        // counts in range however long the words get
+        if (largest > 0) {
+            for (double& value : next) {
+                value /= largest;
+            }
+        }
+        completions.swap(next);
+        has_words[remaining] = completions[0] > 0;
+    }
+}
+
+bool WordSampler::HasWords(size_t length) const
+{
+    return length <= max_length && has_words[length];
+}
+
+bool WordSampler::Sample(size_t length, std::mt19937_64& rng, std::string& out) const
+{
+    if (length > max_length) {
+        throw std::invalid_argument("Word length " + std::to_string(length) +
+            " exceeds the sampler's maximum of " + std::to_string(max_length));
+    }
+    if (!has_words[length]) {
+        return false;
+    }
+
+    const size_t num_edges = target.size();
+    size_t old_size = out.size();
+    out.resize(old_size + length);
+    char* pos = &out[old_size];
+    size_t q = 0;
+    for (size_t remaining = length; remaining > 0; remaining--) {
+        const double* cum = cumulative.data() + (remaining - 1) * num_edges;
+        const double* first = cum + offset[q];
+        const double* last = cum + offset[q + 1];
+
+        // 53 random bits -> [0, 1), scaled to the state's total
+        double u = static_cast<double>(rng() >> 11) * 0x1.0p-53 * last[-1];
+        const double* hit = std::min(std::upper_bound(first, last, u), last - 1);
+        size_t e = static_cast<size_t>(hit - cum);
+
+        // Where u fell inside the edge's share picks among its characters
+        double low = hit == first ? 0.0 : hit[-1];
+        size_t width = symbol_offset[e + 1] - symbol_offset[e];
+        size_t k = *hit > low ? static_cast<size_t>((u - low) / (*hit - low) * static_cast<double>(width)) : 0;
+        *pos++ = symbols[symbol_offset[e] + std::min(k, width - 1)];
+        q = target[e];
+    }
+    return true;
+}
+
+WordSampler::Corpus WordSampler::SampleCorpus(size_t count, const vector<double>& length_weights,
+                                              std::mt19937_64& rng) const
+{
+    if (length_weights.size() > max_length + 1) {
+        throw std::invalid_argument("Length weights go beyond the sampler's maximum length of " +
+            std::to_string(max_length));
+    }
+    vector<double> weights(length_weights.size(), 0.0);
+    double expected_length = 0;
+    double total = 0;
+    for (size_t length = 0; length < length_weights.size(); length++) {
+        if (has_words[length] && length_weights[length] > 0) {
+            weights[length] = length_weights[length];
+            total += weights[length];
+            expected_length += weights[length] * static_cast<double>(length);
+        }
+    }
+    if (total <= 0) {
+        throw std::invalid_argument("No accepted words have a length with positive weight");
+    }
+
+    Corpus corpus;
+    corpus.offsets.reserve(count + 1);
+    corpus.offsets.push_back(0);
+    corpus.data.reserve(static_cast<size_t>(expected_length / total * static_cast<double>(count) * 1.1));
+    std::discrete_distribution<size_t> pick_length(weights.begin(), weights.end());
+    for (size_t i = 0; i < count; i++) {
+        Sample(pick_length(rng), rng, corpus.data);
+        corpus.offsets.push_back(corpus.data.size());
+    }
+    return corpus;
+}
@@ -0,0 +1,67 @@
+#include "dfa_table.h"
+#include "parallel_for.h"
+#include <limits>
+#include <stdexcept>
+
+
+DfaTable DfaTable::Compile(const ByteClasses& alphabet,
+                           const std::uint32_t* transitions,
+                           const std::pmr::vector<bool>& accepting,
+                           const std::pmr::vector<bool>& absorbing,
+                           std::size_t initial_state,
+                           const TablePlacement& placement)
+{
+    const std::size_t num_columns = alphabet.NumColumns();
+    const std::size_t num_states = absorbing.size();
+    const std::size_t num_rows = num_states + 1;  // plus the invalid-symbol sentinel
+    if (num_rows > std::numeric_limits<StateId>::max() / (num_columns + 1)) {
+        throw std::invalid_argument("Automaton has too many states for a 32-bit transition table");
+    }
+
+    std::pmr::memory_resource* memory = placement.arena ? placement.arena : std::pmr::get_default_resource();
+    DfaTable table(memory);
+    table.stride = static_cast<StateId>(num_columns + 1);
+
+    // Sentinel first, then sinks, then everything else, each in state order
+    std::size_t num_absorbing = 0;
+    for (std::size_t i = 0; i < num_states; i++) {
+        num_absorbing += absorbing[i];
+    }
+    table.special_end = static_cast<StateId>(num_absorbing + 1) * table.stride;
+
+    table.row_of.resize(num_states);
+    table.state_of.assign(num_rows, 0);
+    std::size_t next_special = 1;
+    std::size_t next_other = num_absorbing + 1;
+    for (std::size_t i = 0; i < num_states; i++) {
+        std::size_t k = absorbing[i] ? next_special++ : next_other++;
+        table.row_of[i] = static_cast<StateId>(k) * table.stride;
+        table.state_of[k] = static_cast<std::uint32_t>(i);
+    }
+
+    table.accepting.assign(num_rows, 0);
+    for (std::size_t i = 0; i < num_states; i++) {
+        table.accepting[table.row_of[i] / table.stride] = accepting[i];
+    }
+
+    // The sentinel row and every invalid column stay at kInvalidRow
+    table.next = decltype(table.next)(TableAllocator<StateId>(placement.huge_pages, placement.arena));
+    table.next.assign(num_rows * table.stride, kInvalidRow);
+    ParallelFor(num_states, 1 << 14, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const std::uint32_t* source = transitions + i * num_columns;
+            StateId* row = table.next.data() + table.row_of[i];
+            for (std::size_t col = 0; col < num_columns; col++) {
+                row[col] = table.row_of[source[col]];
+            }
+        }
+    });
+
+    for (unsigned b = 0; b < 256; b++) {
+        int col = alphabet.ColumnOf(static_cast<char>(b));
+        table.column_of[b] = static_cast<std::uint16_t>(col < 0 ? num_columns : static_cast<std::size_t>(col));
+    }
+
+    table.start = table.row_of[initial_state];
+    return table;
+}
@@ -0,0 +1,328 @@
+#include "differential.h"
+#include "automaton_io.h"
+#include "incremental.h"
+#include "language.h"
+#include "prefix_cache.h"
+#include "range_matcher.h"
+#include "result_cache.h"
+#include "state_map.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+using std::vector;
+using std::string;
+using std::string_view;
+using StateId = DfaTable::StateId;
+
+namespace {
+
+using Words = vector<string_view>;
+using Results = vector<ReadResult>;
+
+ReadResult ResultOfRow(const DfaTable& table, StateId row)
+{
+    if (row == DfaTable::kInvalidRow) {
+        return ReadResult::InvalidSymbol;
+    }
+    return table.IsAccepting(row) ? ReadResult::Accepted : ReadResult::Rejected;
+}
+
+const char* NameOf(ReadResult result)
+{
+    switch (result) {
+    case ReadResult::Accepted:
+        return "Accepted";
+    case ReadResult::Rejected:
+        return "Rejected";
+    default:
+        return "InvalidSymbol";
+    }
+}
+
+ReadEngine ReadManyEngine(size_t lanes)
+{
+    return {"ReadMany, " + std::to_string(lanes) + (lanes == 1 ? " lane" : " lanes"),
+            [lanes](const Automaton& dfa, const Words& words, Results& results) {
+                ReadMany(dfa, words, results, lanes);
+            }};
+}
+
+vector<ReadEngine> BuildEngines()
+{
+    vector<ReadEngine> engines;
+    for (size_t lanes : {size_t{1}, size_t{4}, size_t{8}, size_t{16}}) {
+        engines.push_back(ReadManyEngine(lanes));
+    }
+
+    // 分三段读，后两段不重置状态
+    engines.push_back({"Read in pieces", [](const Automaton& dfa, const Words& words, Results& results) {
+        Automaton reader = dfa;
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            string_view word = words[i];
+            const size_t a = word.size() / 3;
+            const size_t b = 2 * word.size() / 3;
+            try {
+                reader.Read(string(word.substr(0, a)));
+                reader.Read(string(word.substr(a, b - a)), false);
+                results[i] = reader.Read(string(word.substr(b)), false) ? ReadResult::Accepted : ReadResult::Rejected;
+            } catch (const std::invalid_argument&) {
+                results[i] = ReadResult::InvalidSymbol;
+            }
+        }
+    }});
+
+    engines.push_back({"Huge pages, NUMA replicas", [](const Automaton& dfa, const Words& words, Results& results) {
+        TablePlacement placement;
+        placement.huge_pages = HugePages::Transparent;
+        placement.numa_replicas = true;
+        ReferenceRead(Automaton(dfa.GetByteClasses(), dfa.GetTransitionMatrix(), dfa.GetAcceptingStates(),
+                                Validation::Full, placement),
+                      words, results);
+    }});
+
+    engines.push_back({"Text round trip", [](const Automaton& dfa, const Words& words, Results& results) {
+        std::stringstream buffer;
+        SaveAutomaton(buffer, dfa);
+        ReferenceRead(LoadAutomaton(buffer), words, results);
+    }});
+
+    engines.push_back({"Binary round trip", [](const Automaton& dfa, const Words& words, Results& results) {
+        std::stringstream buffer;
+        SaveAutomatonBinary(buffer, dfa);
+        ReferenceRead(LoadAutomatonBinary(buffer), words, results);
+    }});
+
+    engines.push_back({"Minimized", [](const Automaton& dfa, const Words& words, Results& results) {
+        ReferenceRead(Minimize(dfa), words, results);
+    }, true});
+
+    engines.push_back({"State maps, 3 pieces", [](const Automaton& dfa, const Words& words, Results& results) {
+        const DfaTable& table = dfa.GetTable();
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            string_view word = words[i];
+            const size_t a = word.size() / 3;
+            const size_t b = 2 * word.size() / 3;
+            StateMap map = Compose(Compose(ComputeStateMap(table, word.substr(0, a)),
+                                           ComputeStateMap(table, word.substr(a, b - a))),
+                                   ComputeStateMap(table, word.substr(b)));
+            results[i] = ResultOfRow(table, map.Apply(table.start));
+        }
+    }});
+
+    engines.push_back({"ScanParallel", [](const Automaton& dfa, const Words& words, Results& results) {
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            results[i] = ResultOfRow(dfa.GetTable(), ScanParallel(dfa, words[i], 1).row);
+        }
+    }});
+
+    // 两半分别给出，中间插入再删掉一段，短段迫使分裂和合并
+    engines.push_back({"IncrementalMatcher", [](const Automaton& dfa, const Words& words, Results& results) {
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            string_view word = words[i];
+            const size_t half = word.size() / 2;
+            IncrementalMatcher matcher(dfa, string(word.substr(0, half)), 8);
+            matcher.Insert(half, word.substr(half));
+            matcher.Insert(half, "\xff edit \x01");
+            matcher.Erase(half, 8);
+            results[i] = matcher.Result();
+        }
+    }});
+
+    // 所有词拼成一个缓冲区，按区间查询；预算很小，块和树节点都会用到
+    engines.push_back({"RangeMatcher", [](const Automaton& dfa, const Words& words, Results& results) {
+        string buffer;
+        vector<std::pair<size_t, size_t>> ranges;
+        for (string_view word : words) {
+            ranges.emplace_back(buffer.size(), buffer.size() + word.size());
+            buffer.append(word);
+        }
+        RangeMatcher matcher(dfa, buffer, size_t{1} << 16);
+        matcher.QueryMany(ranges, results);
+    }});
+
+    engines.push_back({"PrefixCache", [](const Automaton& dfa, const Words& words, Results& results) {
+        PrefixCache cache(dfa, 4096, 4);
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            try {
+                results[i] = cache.Read(words[i]) ? ReadResult::Accepted : ReadResult::Rejected;
+            } catch (const std::invalid_argument&) {
+                results[i] = ReadResult::InvalidSymbol;
+            }
+        }
+    }});
+
+    engines.push_back({"ResultCache", [](const Automaton& dfa, const Words& words, Results& results) {
+        ResultCache cache(dfa, 4096, 32);
+        results.resize(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            results[i] = cache.Read(words[i]);
+        }
+    }});
+    return engines;
+}
+
+} // namespace
+
+const vector<ReadEngine>& ReadEngines()
+{
+    static const vector<ReadEngine> engines = BuildEngines();
+    return engines;
+}
+
+void ReferenceRead(const Automaton& dfa, const Words& words, Results& results)
+{
+    Automaton reader = dfa;
+    results.resize(words.size());
+    for (size_t i = 0; i < words.size(); i++) {
+        try {
+            results[i] = reader.Read(string(words[i])) ? ReadResult::Accepted : ReadResult::Rejected;
+        } catch (const std::invalid_argument&) {
+            results[i] = ReadResult::InvalidSymbol;
+        }
+    }
+}
+
+string Disagreement::Describe(const Words& words) const
+{
+    string word;
+    for (char c : words[this->word]) {
+        if (c >= 0x21 && c <= 0x7e && c != '\\') {
+            word += c;
+        } else {
+            char escaped[5];
+            std::snprintf(escaped, sizeof(escaped), "\\x%02x", static_cast<unsigned char>(c));
+            word += escaped;
+        }
+    }
+    if (!error.empty()) {
+        return engine + " threw on word " + std::to_string(this->word) + " \"" + word + "\": " + error;
+    }
+    return engine + " returned " + NameOf(actual) + " for word " + std::to_string(this->word) + " \"" + word +
+           "\", Read returned " + NameOf(expected);
+}
+
+vector<Disagreement> CompareEngines(const Automaton& dfa, const Words& words, const vector<ReadEngine>& engines)
+{
+    Results expected;
+    ReferenceRead(dfa, words, expected);
+
+    // 只保留语言的引擎只比较字母表内的单词，index记录它们在原批次中的位置
+    const ByteClasses& classes = dfa.GetByteClasses();
+    vector<size_t> index;
+    Words valid_words;
+    Results valid_expected;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (std::all_of(words[i].begin(), words[i].end(), [&](char c) { return classes.Contains(c); })) {
+            index.push_back(i);
+            valid_words.push_back(words[i]);
+            valid_expected.push_back(expected[i]);
+        }
+    }
+
+    vector<Disagreement> disagreements;
+    Results actual;
+    for (const auto& engine : engines) {
+        const Words& given = engine.alphabet_only ? valid_words : words;
+        const Results& wanted = engine.alphabet_only ? valid_expected : expected;
+        auto original = [&](size_t k) { return engine.alphabet_only ? index[k] : k; };
+        if (given.empty()) {
+            continue;
+        }
+
+        Disagreement d;
+        d.engine = engine.name;
+        actual.clear();
+        try {
+            engine.run(dfa, given, actual);
+        } catch (const std::exception& e) {
+            d.error = e.what();
+            disagreements.push_back(d);
+            continue;
+        }
+        if (actual.size() != given.size()) {
+            d.word = original(std::min(actual.size(), given.size() - 1));
+            d.error = "returned " + std::to_string(actual.size()) + " results for " + std::to_string(given.size()) +
+                      " words";
+            disagreements.push_back(d);
+            continue;
+        }
+        auto mismatch = std::mismatch(wanted.begin(), wanted.end(), actual.begin());
+        if (mismatch.first != wanted.end()) {
+            d.word = original(static_cast<size_t>(mismatch.first - wanted.begin()));
+            d.expected = *mismatch.first;
+            d.actual = *mismatch.second;
+            disagreements.push_back(d);
+        }
+    }
+    return disagreements;
+}
+
+Automaton GenerateAutomaton(std::mt19937_64& rng, size_t num_states, size_t num_columns)
+{
+    if (num_states == 0 || num_columns == 0 || num_columns > 128) {
+        throw std::invalid_argument("Random automata need 1 to 128 columns and at least one state");
+    }
+    // 随机挑选字节，每列一到两个
+    std::array<uint8_t, 256> bytes;
+    for (size_t b = 0; b < bytes.size(); b++) {
+        bytes[b] = static_cast<uint8_t>(b);
+    }
+    std::shuffle(bytes.begin(), bytes.end(), rng);
+    std::array<uint16_t, 256> column_of;
+    column_of.fill(ByteClasses::kNoColumn);
+    size_t used = 0;
+    for (size_t col = 0; col < num_columns; col++) {
+        column_of[bytes[used++]] = static_cast<uint16_t>(col);
+        if (rng() % 4 == 0) {
+            column_of[bytes[used++]] = static_cast<uint16_t>(col);
+        }
+    }
+
+    vector<vector<int>> M(num_states, vector<int>(num_columns));
+    vector<int> accepting;
+    for (size_t q = 0; q < num_states; q++) {
+        const int self = static_cast<int>(q);
+        const bool sink = q > 0 && rng() % 4 == 0;
+        for (auto& target : M[q]) {
+            target = sink ? self : static_cast<int>(rng() % num_states);
+        }
+        if (rng() % 3 == 0) {
+            accepting.push_back(self);
+        }
+    }
+    return Automaton(ByteClasses::FromTable(column_of, num_columns), std::move(M), std::move(accepting));
+}
+
+vector<string> GenerateWords(std::mt19937_64& rng, const Automaton& dfa, size_t count, size_t max_length)
+{
+    string symbols;
+    for (size_t b = 0; b < 256; b++) {
+        if (dfa.GetByteClasses().Contains(static_cast<char>(b))) {
+            symbols += static_cast<char>(b);
+        }
+    }
+
+    vector<string> words;
+    for (size_t i = 0; i < count; i++) {
+        string word;
+        // 四分之一的词重复或延长前面的词
+        if (!words.empty() && rng() % 4 == 0) {
+            word = words[rng() % words.size()];
+        }
+        const size_t length = rng() % (max_length + 1);
+        while (word.size() < length) {
+            word += rng() % 64 == 0 ? static_cast<char>(rng() % 256) : symbols[rng() % symbols.size()];
+        }
+        word.resize(std::min(word.size(), max_length));
+        words.push_back(std::move(word));
+    }
+    return words;
+}
@@ -0,0 +1,184 @@
+#include "incremental.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <stdexcept>
+
+using std::vector;
+using std::string;
+using std::string_view;
+
+namespace {
+
+// 把文本切成至多segment_size字节的段
+void AppendSegments(string_view text, size_t segment_size, vector<string>& out)
+{
+    for (size_t begin = 0; begin < text.size(); begin += segment_size) {
+        out.emplace_back(text.substr(begin, segment_size));
+    }
+}
+
+} // namespace
+
+IncrementalMatcher::IncrementalMatcher(const Automaton& dfa, string text, size_t segment_size)
+    : dfa(dfa), segment_size(segment_size)
+{
+    if (segment_size == 0) {
+        throw std::invalid_argument("Segment size must be positive");
+    }
+    const DfaTable& table = this->dfa.GetTable();
+    identity = StateMap::Identity(table);
+
+    // 各段的状态映射并行计算
+    vector<string> pieces;
+    AppendSegments(text, segment_size, pieces);
+    if (pieces.empty()) {
+        pieces.emplace_back();
+    }
+    segments.resize(pieces.size());
+    ParallelFor(pieces.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            segments[k].map = ComputeStateMap(table, pieces[k]);
+            segments[k].text = std::move(pieces[k]);
+        }
+    });
+    Rebuild();
+}
+
+const StateMap& IncrementalMatcher::MapOf(size_t node) const
+{
+    if (node < capacity) {
+        return inner[node];
+    }
+    size_t k = node - capacity;
+    return k < segments.size() ? segments[k].map : identity;
+}
+
+void IncrementalMatcher::Update(size_t node)
+{
+    lengths[node] = lengths[2 * node] + lengths[2 * node + 1];
+    // 只有唯一的段可以为空，所以右侧长度为0时下面全是填充叶子，直接复制左侧
+    if (lengths[2 * node + 1] == 0) {
+        inner[node] = MapOf(2 * node);
+    } else {
+        inner[node] = Compose(MapOf(2 * node), MapOf(2 * node + 1));
+    }
+}
+
+void IncrementalMatcher::Rebuild()
+{
+    capacity = 1;
+    while (capacity < segments.size()) {
+        capacity *= 2;
+    }
+    inner.assign(capacity, StateMap());
+    lengths.assign(2 * capacity, 0);
+    for (size_t k = 0; k < segments.size(); k++) {
+        lengths[capacity + k] = segments[k].text.size();
+    }
+    for (size_t node = capacity - 1; node >= 1; node--) {
+        Update(node);
+    }
+}
+
+size_t IncrementalMatcher::SegmentAt(size_t pos, size_t& offset) const
+{
+    // 末尾位置落在最后一个非空段的结尾
+    size_t node = 1;
+    while (node < capacity) {
+        if (pos < lengths[2 * node] || lengths[2 * node + 1] == 0) {
+            node = 2 * node;
+        } else {
+            pos -= lengths[2 * node];
+            node = 2 * node + 1;
+        }
+    }
+    offset = pos;
+    return node - capacity;
+}
+
+void IncrementalMatcher::Replace(size_t pos, size_t count, string_view replacement)
+{
+    if (pos > Size()) {
+        throw std::invalid_argument("Edit position " + std::to_string(pos) + " is past the end of the text");
+    }
+    count = std::min(count, Size() - pos);
+    const DfaTable& table = dfa.GetTable();
+
+    size_t offset = 0;
+    const size_t first = SegmentAt(pos, offset);
+    size_t last = first;
+    size_t end_offset = offset + count;
+    while (end_offset > segments[last].text.size()) {
+        end_offset -= segments[last].text.size();
+        last++;
+    }
+
+    string content;
+    content.reserve(offset + replacement.size() + segments[last].text.size() - end_offset);
+    content.append(segments[first].text, 0, offset);
+    content.append(replacement);
+    content.append(segments[last].text, end_offset, string::npos);
+
+    // 常见情况：编辑只落在一个段内，重新扫描该段并更新到根的路径
+    if (first == last && content.size() <= 2 * segment_size && (!content.empty() || segments.size() == 1)) {
+        segments[first].map = ComputeStateMap(table, content);
+        segments[first].text = std::move(content);
+        size_t node = capacity + first;
+        lengths[node] = segments[first].text.size();
+        for (node /= 2; node >= 1; node /= 2) {
+            Update(node);
+        }
+        return;
+    }
+
+    vector<string> pieces;
+    AppendSegments(content, segment_size, pieces);
+    if (pieces.empty() && last - first + 1 == segments.size()) {
+        pieces.emplace_back();
+    }
+    vector<Segment> replaced(pieces.size());
+    ParallelFor(pieces.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            replaced[k].map = ComputeStateMap(table, pieces[k]);
+            replaced[k].text = std::move(pieces[k]);
+        }
+    });
+
+    const auto first_it = segments.begin() + static_cast<std::ptrdiff_t>(first);
+    if (replaced.size() == last - first + 1) {
+        std::move(replaced.begin(), replaced.end(), first_it);
+        for (size_t k = first; k <= last; k++) {
+            size_t node = capacity + k;
+            lengths[node] = segments[k].text.size();
+            for (node /= 2; node >= 1; node /= 2) {
+                Update(node);
+            }
+        }
+        return;
+    }
+    // 段数改变时叶子位置移动，内部节点全部重新组合，各段的映射保留
+    segments.erase(first_it, segments.begin() + static_cast<std::ptrdiff_t>(last + 1));
+    segments.insert(segments.begin() + static_cast<std::ptrdiff_t>(first),
+                    std::make_move_iterator(replaced.begin()), std::make_move_iterator(replaced.end()));
+    Rebuild();
+}
+
+ReadResult IncrementalMatcher::Result() const
+{
+    const DfaTable& table = dfa.GetTable();
+    DfaTable::StateId row = MapOf(1).Apply(table.start);
+    if (row == DfaTable::kInvalidRow) {
+        return ReadResult::InvalidSymbol;
+    }
+    return table.IsAccepting(row) ? ReadResult::Accepted : ReadResult::Rejected;
+}
+
+string IncrementalMatcher::Text() const
+{
+    string text;
+    text.reserve(Size());
+    for (const auto& segment : segments) {
+        text += segment.text;
+    }
+    return text;
+}
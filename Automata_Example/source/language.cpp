@@ -0,0 +1,483 @@
+#include "language.h"
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+// The joint refinement of two alphabets: one column per distinct pair of
+// columns (a's, b's) that some byte has, so both automata can be stepped over it
+struct SharedAlphabet
+{
+    ByteClasses classes;
+    vector<int> column_a;  // a's column for each shared column, or -1
+    vector<int> column_b;
+    string symbols;        // one byte of each shared column, for witnesses
+};
+
+// One automaton re-indexed over the shared columns, with an explicit dead
+// state (index num_states) for columns outside its own alphabet
+struct Side
+{
+    uint32_t num_states = 0;  // including the dead state
+    uint32_t start = 0;
+    vector<uint32_t> next;    // next[state * columns + column]
+    vector<bool> accepting;
+};
+
+// Bytes known to neither automaton stay outside the shared alphabet
+SharedAlphabet ShareAlphabets(const Automaton& a, const Automaton& b)
+{
+    const auto& table_a = a.GetByteClasses().Table();
+    const auto& table_b = b.GetByteClasses().Table();
+    std::map<std::pair<uint16_t, uint16_t>, uint16_t> columns;
+    std::array<uint16_t, 256> column_of;
+    column_of.fill(ByteClasses::kNoColumn);
+
+    SharedAlphabet shared;
+    for (size_t byte = 0; byte < 256; byte++) {
+        uint16_t ca = table_a[byte];
+        uint16_t cb = table_b[byte];
+        if (ca == ByteClasses::kNoColumn && cb == ByteClasses::kNoColumn) {
+            continue;
+        }
+        auto [it, inserted] = columns.emplace(std::make_pair(ca, cb), static_cast<uint16_t>(columns.size()));
+        if (inserted) {
+            shared.column_a.push_back(ca == ByteClasses::kNoColumn ? -1 : ca);
+            shared.column_b.push_back(cb == ByteClasses::kNoColumn ? -1 : cb);
+            shared.symbols += static_cast<char>(byte);
+        }
+        column_of[byte] = it->second;
+    }
+    shared.classes = ByteClasses::FromTable(column_of, columns.size());
+    return shared;
+}
+
+Side MakeSide(const Automaton& dfa, const vector<int>& column_of)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    const uint32_t dead = static_cast<uint32_t>(M.size());
+    const size_t k = column_of.size();
+
+    Side side;
+    side.num_states = dead + 1;
+    side.start = static_cast<uint32_t>(dfa.GetInitialState());
+    side.accepting.assign(side.num_states, false);
+    for (int s : dfa.GetAcceptingStates()) {
+        side.accepting[static_cast<size_t>(s)] = true;
+    }
+
+    side.next.assign(static_cast<size_t>(side.num_states) * k, dead);
+    for (size_t c = 0; c < k; c++) {
+        if (column_of[c] < 0) {
+            continue;
+        }
+        size_t col = static_cast<size_t>(column_of[c]);
+        for (size_t q = 0; q < M.size(); q++) {
+            side.next[q * k + c] = static_cast<uint32_t>(M[q][col]);
+        }
+    }
+    return side;
+}
+
+class UnionFind
+{
+public:
+    explicit UnionFind(size_t n) : parent(n) { std::iota(parent.begin(), parent.end(), 0u); }
+
+    uint32_t Find(uint32_t x)
+    {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // Returns false when x and y were already in the same class
+    bool Unite(uint32_t x, uint32_t y)
+    {
+        x = Find(x);
+        y = Find(y);
+        if (x == y) {
+            return false;
+        }
+        parent[x] = y;
+        return true;
+    }
+
+private:
+    vector<uint32_t> parent;
+};
+
+// Hopcroft-Karp: merge the start states, then keep merging the successors of
+// every merged pair. The languages differ iff some merged pair disagrees on acceptance.
+bool HopcroftKarpEquivalent(const Side& a, const Side& b, size_t num_columns)
+{
+    const uint32_t offset = a.num_states;  // b's states follow a's
+    UnionFind classes(static_cast<size_t>(a.num_states) + b.num_states);
+    std::deque<std::pair<uint32_t, uint32_t>> pending;
+
+    if (a.accepting[a.start] != b.accepting[b.start]) {
+        return false;
+    }
+    classes.Unite(a.start, offset + b.start);
+    pending.emplace_back(a.start, b.start);
+
+    while (!pending.empty()) {
+        auto [p, q] = pending.front();
+        pending.pop_front();
+        for (size_t k = 0; k < num_columns; k++) {
+            uint32_t pa = a.next[p * num_columns + k];
+            uint32_t qb = b.next[q * num_columns + k];
+            if (classes.Unite(pa, offset + qb)) {
+                if (a.accepting[pa] != b.accepting[qb]) {
+                    return false;
+                }
+                pending.emplace_back(pa, qb);
+            }
+        }
+    }
+    return true;
+}
+
+// Breadth-first search over reachable product states for the shortest word
+// leading to a pair that satisfies `target`; `symbols` holds one byte per column
+template <typename Target>
+std::optional<string> ShortestWitness(const Side& a, const Side& b, const string& symbols, Target target)
+{
+    struct Visit
+    {
+        uint64_t parent;
+        char symbol;
+    };
+    auto key = [&](uint32_t p, uint32_t q) { return static_cast<uint64_t>(p) * b.num_states + q; };
+
+    std::unordered_map<uint64_t, Visit> visited;
+    std::deque<std::pair<uint32_t, uint32_t>> frontier;
+    uint64_t start = key(a.start, b.start);
+    visited.emplace(start, Visit{start, '\0'});
+    frontier.emplace_back(a.start, b.start);
+
+    while (!frontier.empty()) {
+        auto [p, q] = frontier.front();
+        frontier.pop_front();
+        if (target(a.accepting[p], b.accepting[q])) {
+            string word;
+            for (uint64_t k = key(p, q); k != start; k = visited[k].parent) {
+                word += visited[k].symbol;
+            }
+            std::reverse(word.begin(), word.end());
+            return word;
+        }
+        for (size_t k = 0; k < symbols.size(); k++) {
+            uint32_t pa = a.next[p * symbols.size() + k];
+            uint32_t qb = b.next[q * symbols.size() + k];
+            if (visited.emplace(key(pa, qb), Visit{key(p, q), symbols[k]}).second) {
+                frontier.emplace_back(pa, qb);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+// Builds the reachable part of the product of `a` and `b`; `accept` decides
+// acceptance of a pair from the acceptance of its components
+template <typename Accept>
+Automaton Product(const Automaton& a, const Automaton& b, Accept accept)
+{
+    SharedAlphabet shared = ShareAlphabets(a, b);
+    const size_t k = shared.classes.NumColumns();
+    Side sa = MakeSide(a, shared.column_a);
+    Side sb = MakeSide(b, shared.column_b);
+
+    std::unordered_map<uint64_t, int> ids;
+    vector<std::pair<uint32_t, uint32_t>> pairs;
+    auto intern = [&](uint32_t p, uint32_t q) {
+        auto [it, inserted] = ids.emplace(static_cast<uint64_t>(p) * sb.num_states + q, static_cast<int>(pairs.size()));
+        if (inserted) {
+            pairs.emplace_back(p, q);
+        }
+        return it->second;
+    };
+
+    vector<vector<int>> M;
+    vector<int> accepting;
+    intern(sa.start, sb.start);
+    for (size_t i = 0; i < pairs.size(); i++) {
+        auto [p, q] = pairs[i];
+        vector<int> row(k);
+        for (size_t c = 0; c < k; c++) {
+            row[c] = intern(sa.next[p * k + c], sb.next[q * k + c]);
+        }
+        M.push_back(std::move(row));
+        if (accept(sa.accepting[p], sb.accepting[q])) {
+            accepting.push_back(static_cast<int>(i));
+        }
+    }
+
+    return Minimize(Automaton(std::move(shared.classes), std::move(M), std::move(accepting), Validation::Trusted));
+}
+
+// Partition of states into blocks, stored so that every block is a contiguous
+// range of `elems` and marking a state moves it to the front of its block
+class RefinablePartition
+{
+public:
+    explicit RefinablePartition(const vector<uint32_t>& states, size_t num_states)
+        : elems(states), loc(num_states), block_of(num_states)
+    {
+        for (size_t i = 0; i < elems.size(); i++) {
+            loc[elems[i]] = i;
+        }
+    }
+
+    // Creates a block from the states of elems[begin, end)
+    uint32_t AddBlock(size_t begin, size_t end)
+    {
+        uint32_t b = static_cast<uint32_t>(first.size());
+        first.push_back(begin);
+        mid.push_back(begin);
+        last.push_back(end);
+        for (size_t i = begin; i < end; i++) {
+            block_of[elems[i]] = b;
+        }
+        return b;
+    }
+
+    size_t NumBlocks() const { return first.size(); }
+    size_t Size(uint32_t b) const { return last[b] - first[b]; }
+    uint32_t BlockOf(uint32_t s) const { return block_of[s]; }
+    uint32_t Representative(uint32_t b) const { return elems[first[b]]; }
+    vector<uint32_t> Members(uint32_t b) const
+    {
+        return vector<uint32_t>(elems.begin() + static_cast<std::ptrdiff_t>(first[b]),
+                                elems.begin() + static_cast<std::ptrdiff_t>(last[b]));
+    }
+
+    // Returns true when this is the first mark in the state's block
+    bool Mark(uint32_t s)
+    {
+        uint32_t b = block_of[s];
+        size_t i = loc[s];
+        if (i < mid[b]) {
+            return false;  // already marked
+        }
+        size_t j = mid[b]++;
+        std::swap(elems[i], elems[j]);
+        loc[elems[i]] = i;
+        loc[elems[j]] = j;
+        return j == first[b];
+    }
+
+    // Splits the marked states of `b` off into a new block; returns that block,
+    // or `b` itself when every state was marked and nothing changed
+    uint32_t Split(uint32_t b)
+    {
+        if (mid[b] == last[b]) {
+            mid[b] = first[b];
+            return b;
+        }
+        size_t begin = first[b];
+        size_t end = mid[b];
+        first[b] = end;
+        mid[b] = end;
+        return AddBlock(begin, end);
+    }
+
+private:
+    vector<uint32_t> elems;
+    vector<size_t> loc;
+    vector<uint32_t> block_of;
+    vector<size_t> first, mid, last;
+};
+
+} // namespace
+
+Automaton Minimize(const Automaton& dfa)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    const size_t n = M.size();
+    const size_t k = dfa.GetNumColumns();
+    vector<bool> accepting(n, false);
+    for (int s : dfa.GetAcceptingStates()) {
+        accepting[static_cast<size_t>(s)] = true;
+    }
+
+    // 只保留从初始状态可达的状态
+    vector<uint32_t> reachable{static_cast<uint32_t>(dfa.GetInitialState())};
+    vector<bool> seen(n, false);
+    seen[reachable[0]] = true;
+    for (size_t i = 0; i < reachable.size(); i++) {
+        for (int target : M[reachable[i]]) {
+            if (!seen[static_cast<size_t>(target)]) {
+                seen[static_cast<size_t>(target)] = true;
+                reachable.push_back(static_cast<uint32_t>(target));
+            }
+        }
+    }
+
+    // Predecessor lists per symbol, restricted to reachable states (CSR)
+    vector<size_t> offsets(n * k + 1, 0);
+    for (uint32_t p : reachable) {
+        for (size_t c = 0; c < k; c++) {
+            offsets[static_cast<size_t>(M[p][c]) * k + c + 1]++;
+        }
+    }
+    for (size_t i = 0; i < n * k; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    vector<uint32_t> predecessors(offsets.back());
+    vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t p : reachable) {
+        for (size_t c = 0; c < k; c++) {
+            predecessors[fill[static_cast<size_t>(M[p][c]) * k + c]++] = p;
+        }
+    }
+
+    // Initial partition: accepting / rejecting
+    vector<uint32_t> ordered;
+    for (uint32_t s : reachable) {
+        if (accepting[s]) {
+            ordered.push_back(s);
+        }
+    }
+    size_t num_accepting = ordered.size();
+    for (uint32_t s : reachable) {
+        if (!accepting[s]) {
+            ordered.push_back(s);
+        }
+    }
+    RefinablePartition partition(ordered, n);
+    vector<uint32_t> worklist;
+    vector<bool> in_worklist;
+    if (num_accepting > 0) {
+        worklist.push_back(partition.AddBlock(0, num_accepting));
+    }
+    if (num_accepting < ordered.size()) {
+        worklist.push_back(partition.AddBlock(num_accepting, ordered.size()));
+    }
+    in_worklist.assign(worklist.size(), true);
+
+    vector<uint32_t> touched;
+    while (!worklist.empty()) {
+        uint32_t splitter = worklist.back();
+        worklist.pop_back();
+        in_worklist[splitter] = false;
+        vector<uint32_t> members = partition.Members(splitter);
+
+        for (size_t c = 0; c < k; c++) {
+            touched.clear();
+            for (uint32_t s : members) {
+                size_t slot = static_cast<size_t>(s) * k + c;
+                for (size_t i = offsets[slot]; i < offsets[slot + 1]; i++) {
+                    if (partition.Mark(predecessors[i])) {
+                        touched.push_back(partition.BlockOf(predecessors[i]));
+                    }
+                }
+            }
+            for (uint32_t b : touched) {
+                uint32_t split = partition.Split(b);
+                if (split == b) {
+                    continue;
+                }
+                in_worklist.push_back(false);
+                // 已在工作表中的块两部分都要处理，否则只需加入较小的一半
+                uint32_t smaller = in_worklist[b] || partition.Size(split) < partition.Size(b) ? split : b;
+                if (!in_worklist[smaller]) {
+                    in_worklist[smaller] = true;
+                    worklist.push_back(smaller);
+                }
+            }
+        }
+    }
+
+    // The initial state's block becomes state 0
+    const size_t num_blocks = partition.NumBlocks();
+    uint32_t initial_block = partition.BlockOf(static_cast<uint32_t>(dfa.GetInitialState()));
+    vector<int> new_id(num_blocks);
+    for (size_t b = 0, next_id = 1; b < num_blocks; b++) {
+        new_id[b] = b == initial_block ? 0 : static_cast<int>(next_id++);
+    }
+
+    vector<vector<int>> minimized(num_blocks);
+    vector<int> minimized_accepting;
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        uint32_t rep = partition.Representative(b);
+        vector<int>& row = minimized[static_cast<size_t>(new_id[b])];
+        for (int target : M[rep]) {
+            row.push_back(new_id[partition.BlockOf(static_cast<uint32_t>(target))]);
+        }
+        if (accepting[rep]) {
+            minimized_accepting.push_back(new_id[b]);
+        }
+    }
+    std::sort(minimized_accepting.begin(), minimized_accepting.end());
+    return Automaton(dfa.GetByteClasses(), std::move(minimized), std::move(minimized_accepting), Validation::Trusted);
+}
+
+Automaton Intersection(const Automaton& a, const Automaton& b)
+{
+    return Product(a, b, [](bool in_a, bool in_b) { return in_a && in_b; });
+}
+
+Automaton Union(const Automaton& a, const Automaton& b)
+{
+    return Product(a, b, [](bool in_a, bool in_b) { return in_a || in_b; });
+}
+
+Automaton Difference(const Automaton& a, const Automaton& b)
+{
+    return Product(a, b, [](bool in_a, bool in_b) { return in_a && !in_b; });
+}
+
+Automaton Complement(const Automaton& a)
+{
+    vector<bool> accepting(a.GetNumStates(), false);
+    for (int s : a.GetAcceptingStates()) {
+        accepting[static_cast<size_t>(s)] = true;
+    }
+    vector<int> flipped;
+    for (size_t s = 0; s < accepting.size(); s++) {
+        if (!accepting[s]) {
+            flipped.push_back(static_cast<int>(s));
+        }
+    }
+    return Automaton(a.GetByteClasses(), a.GetTransitionMatrix(), std::move(flipped), Validation::Trusted);
+}
+
+bool AreEquivalent(const Automaton& a, const Automaton& b)
+{
+    SharedAlphabet shared = ShareAlphabets(a, b);
+    return HopcroftKarpEquivalent(MakeSide(a, shared.column_a), MakeSide(b, shared.column_b),
+                                  shared.classes.NumColumns());
+}
+
+std::optional<string> FindDifference(const Automaton& a, const Automaton& b)
+{
+    SharedAlphabet shared = ShareAlphabets(a, b);
+    Side sa = MakeSide(a, shared.column_a);
+    Side sb = MakeSide(b, shared.column_b);
+    if (HopcroftKarpEquivalent(sa, sb, shared.classes.NumColumns())) {
+        return std::nullopt;
+    }
+    return ShortestWitness(sa, sb, shared.symbols, [](bool in_a, bool in_b) { return in_a != in_b; });
+}
+
+bool IsSubsetOf(const Automaton& a, const Automaton& b)
+{
+    return !FindInclusionCounterexample(a, b).has_value();
+}
+
+std::optional<string> FindInclusionCounterexample(const Automaton& a, const Automaton& b)
+{
+    SharedAlphabet shared = ShareAlphabets(a, b);
+    return ShortestWitness(MakeSide(a, shared.column_a), MakeSide(b, shared.column_b), shared.symbols,
+                           [](bool in_a, bool in_b) { return in_a && !in_b; });
+}
@@ -0,0 +1,152 @@
+#include "lexer.h"
+#include <deque>
+#include <map>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+// Marks a rule that can no longer accept, so all such tuples collapse together
+constexpr uint32_t kRuleDead = UINT32_MAX;
+
+} // namespace
+
+Lexer::Lexer(const vector<Automaton>& rules)
+{
+    // 规则中转移完全相同的列先合并，merged[r][col] 为合并后的编号
+    vector<vector<uint16_t>> merged(rules.size());
+    for (size_t r = 0; r < rules.size(); r++) {
+        const auto& M = rules[r].GetTransitionMatrix();
+        std::map<vector<int>, uint16_t> distinct;
+        vector<int> targets(M.size());
+        for (size_t col = 0; col < rules[r].GetNumColumns(); col++) {
+            for (size_t q = 0; q < M.size(); q++) {
+                targets[q] = M[q][col];
+            }
+            merged[r].push_back(distinct.emplace(targets, static_cast<uint16_t>(distinct.size())).first->second);
+        }
+    }
+
+    // 各规则下编号都相同的字节转移完全相同，合并为一列，symbols保存每列的一个代表字节；
+    // 没有规则使用的字节进入死列
+    std::map<vector<uint16_t>, uint16_t> columns;
+    std::array<uint16_t, 256> joint_column;
+    joint_column.fill(ByteClasses::kNoColumn);
+    string symbols;
+    vector<uint16_t> signature(rules.size());
+    for (size_t byte = 0; byte < 256; byte++) {
+        bool used = false;
+        for (size_t r = 0; r < rules.size(); r++) {
+            uint16_t col = rules[r].GetByteClasses().Table()[byte];
+            signature[r] = col == ByteClasses::kNoColumn ? col : merged[r][col];
+            used = used || col != ByteClasses::kNoColumn;
+        }
+        if (!used) {
+            continue;
+        }
+        auto [it, inserted] = columns.emplace(signature, static_cast<uint16_t>(columns.size()));
+        if (inserted) {
+            symbols += static_cast<char>(byte);
+        }
+        joint_column[byte] = it->second;
+    }
+
+    const uint32_t num_columns = static_cast<uint32_t>(symbols.size());
+    const uint32_t dead_column = num_columns;
+    const uint32_t kind_column = num_columns + 1;
+    stride = num_columns + 2;
+    for (size_t byte = 0; byte < 256; byte++) {
+        column_of[byte] = joint_column[byte] == ByteClasses::kNoColumn ? static_cast<uint16_t>(dead_column)
+                                                                        : joint_column[byte];
+    }
+
+    // Successor of one rule state on one character, kRuleDead once the rule can't match
+    auto step = [&](size_t r, uint32_t q, char c) -> uint32_t {
+        if (q == kRuleDead) {
+            return kRuleDead;
+        }
+        const Automaton& rule = rules[r];
+        int col = rule.GetByteClasses().ColumnOf(c);
+        if (col < 0) {
+            return kRuleDead;
+        }
+        int t = rule.GetTransitionMatrix()[q][static_cast<size_t>(col)];
+        return rule.IsDeadState(t) ? kRuleDead : static_cast<uint32_t>(t);
+    };
+
+    // 组合状态是各规则状态的元组；全部规则都失效的元组即为死状态（行0）
+    vector<uint32_t> dead_tuple(rules.size(), kRuleDead);
+    vector<uint32_t> initial(rules.size());
+    for (size_t r = 0; r < rules.size(); r++) {
+        int s = rules[r].GetInitialState();
+        initial[r] = rules[r].IsDeadState(s) ? kRuleDead : static_cast<uint32_t>(s);
+    }
+
+    std::map<vector<uint32_t>, uint32_t> ids;
+    vector<vector<uint32_t>> tuples;
+    auto id_of = [&](const vector<uint32_t>& tuple) {
+        auto inserted = ids.emplace(tuple, static_cast<uint32_t>(tuples.size()));
+        if (inserted.second) {
+            tuples.push_back(tuple);
+            next.resize(next.size() + stride, kDeadRow);
+        }
+        return inserted.first->second * stride;
+    };
+    id_of(dead_tuple);
+    start = id_of(initial);
+
+    vector<uint32_t> target(rules.size());
+    for (size_t i = 1; i < tuples.size(); i++) {
+        const uint32_t row = static_cast<uint32_t>(i) * stride;
+        for (uint32_t k = 0; k < num_columns; k++) {
+            for (size_t r = 0; r < rules.size(); r++) {
+                target[r] = step(r, tuples[i][r], symbols[k]);
+            }
+            uint32_t to = id_of(target);
+            next[row + k] = to;
+        }
+
+        // Lowest-numbered accepting rule wins
+        for (size_t r = 0; r < rules.size(); r++) {
+            uint32_t q = tuples[i][r];
+            if (q != kRuleDead && rules[r].GetTable().IsAccepting(rules[r].GetTable().row_of[q])) {
+                next[row + kind_column] = static_cast<uint32_t>(r) + 1;
+                break;
+            }
+        }
+    }
+}
+
+size_t Lexer::Tokenize(const string& text, vector<Token>& tokens) const
+{
+    tokens.clear();
+    const uint32_t* table = next.data();
+    const uint16_t* columns = column_of.data();
+    const uint32_t kind_column = stride - 1;
+    const size_t n = text.size();
+
+    size_t pos = 0;
+    while (pos < n) {
+        uint32_t row = start;
+        uint32_t best_kind = 0;
+        size_t best_end = pos;
+        for (size_t i = pos; i < n;) {
+            row = table[row + columns[static_cast<unsigned char>(text[i])]];
+            if (row == kDeadRow) {
+                break;
+            }
+            i++;
+            if (uint32_t kind = table[row + kind_column]) {
+                best_kind = kind;
+                best_end = i;
+            }
+        }
+        if (best_end == pos) {
+            return pos;
+        }
+        tokens.push_back(Token{static_cast<int>(best_kind - 1), pos, best_end - pos});
+        pos = best_end;
+    }
+    return n;
+}
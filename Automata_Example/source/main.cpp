@@ -1,66 +1,405 @@
-#include "automaton.h"
-#include <vector>
-#include <map>
-#include <iostream>
+#include "automaton_io.h"
+#include "buffered_writer.h"
+#include "multi_read.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
 #include <string>
-#include <limits>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 using std::vector;
-using std::map;
 using std::string;
+using std::string_view;
+
+namespace {
 
-int main()
+enum class OutputMode
 {
-    // 创建一个接受以'b'结尾的字符串的DFA
-    vector<vector<int>> M{{0, 1}, {0, 1}};
-    map<char, int> A{{'a', 0}, {'b', 1}}; 
-    vector<int> S{1};
-    Automaton ends_with_b(A, M, S);
-    
-    // 显示自动机的转移表
-    std::cout << "DFA that accepts strings ending with 'b':\n";
-    ends_with_b.PrintTransitionTable();
-    
-    std::cout << "\nThis automaton accepts strings containing only 'a' and 'b' that end with 'b'.\n";
-    
-    std::string input;
-    
-    while (true) {
-        // 重置自动机状态
-        ends_with_b.Reset();
-        
-        // 提示用户输入
-        std::cout << "\nPlease enter a string (or 'quit' to exit): ";
-        std::getline(std::cin, input);
-        
-        // 检查是否要退出
-        if (input == "quit") {
-            break;
+    Verdicts,  // one verdict per input line
+    Accepted,  // only the accepted lines, like grep
+    Rejected,  // only the rejected and invalid lines, like grep -v
+    None
+};
+
+struct Options
+{
+    string dfa_path;
+    vector<string> inputs;  // empty means stdin, as does "-"
+    bool binary = false;
+    OutputMode mode = OutputMode::Verdicts;
+    size_t workers = 1;
+    bool stats = false;
+};
+
+struct Totals
+{
+    size_t lines = 0;
+    size_t accepted = 0;
+    size_t invalid = 0;
+    size_t bytes = 0;
+};
+
+// 每次最多读入这么多字节；一块中的完整行一起判定后立即写出
+constexpr size_t kBlockSize = 1 << 22;
+// 每个工作线程至少分到这么多行，否则不值得分给更多线程
+constexpr size_t kMinLinesPerWorker = 4096;
+
+// 常驻的工作线程：每块输入都交给同一组线程，而不是每块重新创建和回收。
+// 调用Run的线程自己充当0号工作线程
+class WorkerThreads
+{
+public:
+    explicit WorkerThreads(size_t count) : errors(std::max<size_t>(1, count))
+    {
+        for (size_t w = 1; w < count; w++) {
+            threads.emplace_back([this, w] { Loop(w); });
+        }
+    }
+
+    ~WorkerThreads()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    size_t Size() const { return errors.size(); }
+
+    // 在前n个工作线程上各运行一次task(w)，全部结束后返回；
+    // 与ParallelFor一样，出错时重新抛出编号最小的那个异常
+    void Run(size_t n, const std::function<void(size_t)>& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &task;
+            active = n;
+            remaining = n - 1;
+            generation++;
+        }
+        wake.notify_all();
+        RunTask(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return remaining == 0; });
+            current = nullptr;
+        }
+        for (size_t w = 0; w < n; w++) {
+            if (errors[w]) {
+                std::exception_ptr error = errors[w];
+                std::fill(errors.begin(), errors.end(), nullptr);
+                std::rethrow_exception(error);
+            }
         }
-        
-        // 尝试处理输入
+    }
+
+private:
+    vector<std::thread> threads;
+    vector<std::exception_ptr> errors;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* current = nullptr;
+    size_t active = 0;
+    size_t remaining = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void Loop(size_t w)
+    {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                if (w >= active) {
+                    continue;
+                }
+            }
+            RunTask(w);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    void RunTask(size_t w)
+    {
         try {
-            bool accepted = ends_with_b.Read(input);
-            
-            // 如果代码执行到这里，说明输入有效
-            std::cout << "Input is valid. ";
-            
-            if (accepted) {
-                std::cout << "The string '" << input << "' is ACCEPTED by the automaton.\n";
-            } else {
-                std::cout << "The string '" << input << "' is REJECTED by the automaton.\n";
-            }
-            
-            // 输出最终状态
-            ends_with_b.PrintCurrentState();
-            
-        } catch (const std::exception& e) {
-            // 输入无效，捕获并显示错误
-            std::cout << "Invalid input: " << e.what() << "\n";
-            std::cout << "Please only use characters 'a' and 'b'.\n";
+            (*current)(w);
+        } catch (...) {
+            errors[w] = std::current_exception();
+        }
+    }
+};
+
+int Usage(const char* program)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <dfa-file> [input-file...]\n"
+        "Matches every line of the input files (or stdin, also named '-') against\n"
+        "the DFA. A '\\r' before the newline is not part of the line.\n"
+        "  -b        the DFA file is a binary image\n"
+        "  -a        print only accepted lines\n"
+        "  -v        print only rejected and invalid lines\n"
+        "  -q        print nothing per line\n"
+        "  -j N      match with N worker threads (0: one per CPU)\n"
+        "  -s        print a summary to stderr\n"
+        "Without -a, -v or -q each line produces 'accept', 'reject' or 'invalid'.\n"
+        "Exit status is 0 if some line was accepted, 1 if none was, 2 on errors.\n",
+        program);
+    return 2;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        string flag = argv[i];
+        if (flag == "--") {
+            i++;
+            break;
+        } else if (flag == "-b") {
+            options.binary = true;
+        } else if (flag == "-a") {
+            options.mode = OutputMode::Accepted;
+        } else if (flag == "-v") {
+            options.mode = OutputMode::Rejected;
+        } else if (flag == "-q") {
+            options.mode = OutputMode::None;
+        } else if (flag == "-s") {
+            options.stats = true;
+        } else if (flag == "-j" && i + 1 < argc) {
+            try {
+                options.workers = std::stoul(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (options.workers == 0) {
+                options.workers = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else {
+            return false;
+        }
+    }
+    if (i >= argc) {
+        return false;
+    }
+    options.dfa_path = argv[i++];
+    options.inputs.assign(argv + i, argv + argc);
+    return true;
+}
+
+Automaton LoadDfa(const Options& options)
+{
+    if (!options.binary) {
+        return LoadAutomatonFile(options.dfa_path);
+    }
+    std::ifstream in(options.dfa_path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open DFA file: " + options.dfa_path);
+    }
+    return LoadAutomatonBinary(in);
+}
+
+class LineMatcher
+{
+public:
+    // 与ParallelFor一样，线程数不超过CPU数
+    LineMatcher(const Automaton& dfa, const Options& options, BufferedWriter& out)
+        : dfa(dfa), options(options), out(out),
+          workers(std::min<size_t>(options.workers, std::max(1u, std::thread::hardware_concurrency()))),
+          parts(workers.Size()), verdicts(workers.Size())
+    {
+    }
+
+    // 读取整个文件描述符，按块处理；不足一行的尾部留到下一块
+    void Run(int fd)
+    {
+        string block;
+        size_t pending = 0;
+        while (true) {
+            block.resize(pending + kBlockSize);
+            ssize_t got = read(fd, &block[pending], kBlockSize);
+            // 被信号打断时什么也没读到，重试即可
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                throw std::runtime_error(string("Read failed: ") + std::strerror(errno));
+            }
+            size_t end = pending + static_cast<size_t>(got);
+            if (got == 0) {
+                if (end > 0) {
+                    Match(string_view(block.data(), end));
+                }
+                return;
+            }
+            size_t last_newline = string_view(block.data(), end).rfind('\n');
+            if (last_newline == string_view::npos) {
+                pending = end;
+                continue;
+            }
+            Match(string_view(block.data(), last_newline + 1));
+            pending = end - last_newline - 1;
+            std::memmove(&block[0], block.data() + last_newline + 1, pending);
+        }
+    }
+
+    const Totals& GetTotals() const { return totals; }
+
+private:
+    const Automaton& dfa;
+    const Options& options;
+    BufferedWriter& out;
+    Totals totals;
+    vector<string_view> lines;
+    vector<ReadResult> results;
+    WorkerThreads workers;
+    // 每个工作线程的行和结果，跨块复用
+    vector<vector<string_view>> parts;
+    vector<vector<ReadResult>> verdicts;
+
+    void Match(string_view text)
+    {
+        lines.clear();
+        size_t begin = 0;
+        while (begin < text.size()) {
+            size_t end = text.find('\n', begin);
+            if (end == string_view::npos) {
+                end = text.size();
+            }
+            string_view line = text.substr(begin, end - begin);
+            // CRLF 结尾的行去掉 '\r'，否则每行都会因它成为 invalid
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            lines.push_back(line);
+            begin = end + 1;
+        }
+
+        // 按工作线程数均分各行，每个线程对自己的区间交错执行多个单词
+        results.resize(lines.size());
+        const size_t n = std::min(workers.Size(), std::max<size_t>(1, lines.size() / kMinLinesPerWorker));
+        workers.Run(n, [&](size_t w) {
+            size_t first = lines.size() * w / n;
+            size_t last = lines.size() * (w + 1) / n;
+            parts[w].assign(lines.begin() + static_cast<std::ptrdiff_t>(first),
+                            lines.begin() + static_cast<std::ptrdiff_t>(last));
+            ReadMany(dfa, parts[w], verdicts[w]);
+            std::copy(verdicts[w].begin(), verdicts[w].end(), results.begin() + static_cast<std::ptrdiff_t>(first));
+        });
+
+        for (size_t i = 0; i < lines.size(); i++) {
+            Report(lines[i], results[i]);
+        }
+        totals.bytes += text.size();
+        out.Flush();
+    }
+
+    void Report(string_view line, ReadResult result)
+    {
+        totals.lines++;
+        totals.accepted += result == ReadResult::Accepted;
+        totals.invalid += result == ReadResult::InvalidSymbol;
+        switch (options.mode) {
+        case OutputMode::Verdicts:
+            out.Write(result == ReadResult::Accepted ? "accept\n"
+                      : result == ReadResult::Rejected ? "reject\n" : "invalid\n");
+            break;
+        case OutputMode::Accepted:
+            if (result == ReadResult::Accepted) {
+                out.Write(line);
+                out.Put('\n');
+            }
+            break;
+        case OutputMode::Rejected:
+            if (result != ReadResult::Accepted) {
+                out.Write(line);
+                out.Put('\n');
+            }
+            break;
+        case OutputMode::None:
+            break;
+        }
+    }
+};
+
+} // namespace
+
+// 从文件加载DFA，逐行判定标准输入或输入文件，可在shell管道中使用
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return Usage(argv[0]);
+    }
+
+    try {
+        Automaton dfa = LoadDfa(options);
+        BufferedWriter out(stdout, 1 << 20);
+        LineMatcher matcher(dfa, options, out);
+
+        auto begin = std::chrono::steady_clock::now();
+        if (options.inputs.empty()) {
+            matcher.Run(STDIN_FILENO);
+        }
+        for (const auto& path : options.inputs) {
+            if (path == "-") {
+                matcher.Run(STDIN_FILENO);
+                continue;
+            }
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Cannot open input file: " + path);
+            }
+            try {
+                matcher.Run(fd);
+            } catch (...) {
+                close(fd);
+                throw;
+            }
+            close(fd);
+        }
+        out.Flush();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        const Totals& totals = matcher.GetTotals();
+        if (options.stats) {
+            double seconds = std::max(elapsed.count(), 1e-9);
+            double lines = static_cast<double>(totals.lines);
+            std::fprintf(stderr,
+                "lines %zu  accepted %zu  rejected %zu  invalid %zu\n"
+                "accept ratio %.4f  %.0f lines/s  %.1f MB/s  %.3f s\n",
+                totals.lines, totals.accepted, totals.lines - totals.accepted - totals.invalid, totals.invalid,
+                totals.lines > 0 ? static_cast<double>(totals.accepted) / lines : 0.0,
+                lines / seconds, static_cast<double>(totals.bytes) / seconds / 1e6, elapsed.count());
         }
+        // 与grep一致：有接受的行时返回0，否则返回1
+        return totals.accepted > 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 2;
     }
-    
-    std::cout << "Goodbye!\n";
-    return 0;
-}
\ No newline at end of file
+}
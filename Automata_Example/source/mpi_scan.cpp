@@ -0,0 +1,209 @@
+#include "automaton_io.h"
+#include "parallel_for.h"
+#include "state_map.h"
+#include <mpi.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+// 状态映射在MPI中打包为一个uint64数组：[stride, 行数, to..., matches...]。
+// 整个数组注册为一个派生类型的元素，归约时MPI不会把它拆开；
+// 归约函数不能带上下文，所需的大小都从元素自身读出
+vector<uint64_t> Pack(const StateMap& map)
+{
+    vector<uint64_t> packed(2 + 2 * map.to.size());
+    packed[0] = map.stride;
+    packed[1] = map.to.size();
+    std::copy(map.to.begin(), map.to.end(), packed.begin() + 2);
+    std::copy(map.matches.begin(), map.matches.end(), packed.begin() + 2 + static_cast<std::ptrdiff_t>(map.to.size()));
+    return packed;
+}
+
+// MPI对不可交换的运算按进程编号顺序组合：inout = in 之后接 inout
+void ComposePacked(void* in, void* inout, int* len, MPI_Datatype*)
+{
+    const uint64_t* first = static_cast<const uint64_t*>(in);
+    uint64_t* second = static_cast<uint64_t*>(inout);
+    for (int k = 0; k < *len; k++) {
+        const uint64_t stride = first[0];
+        const size_t n = static_cast<size_t>(first[1]);
+        vector<uint64_t> composed(2 * n);
+        for (size_t q = 0; q < n; q++) {
+            uint64_t middle = first[2 + q] / stride;
+            composed[q] = second[2 + middle];
+            composed[n + q] = first[2 + n + q] + second[2 + n + middle];
+        }
+        std::copy(composed.begin(), composed.end(), second + 2);
+        first += 2 + 2 * n;
+        second += 2 + 2 * n;
+    }
+}
+
+struct Options
+{
+    bool binary = false;
+    string dfa_path;
+    vector<string> inputs;
+};
+
+Automaton LoadDfa(const Options& options)
+{
+    if (!options.binary) {
+        return LoadAutomatonFile(options.dfa_path);
+    }
+    std::ifstream in(options.dfa_path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open DFA file: " + options.dfa_path);
+    }
+    return LoadAutomatonBinary(in);
+}
+
+// 读取所有输入依次拼接后的 [begin, end) 字节
+string ReadRange(const vector<string>& paths, const vector<uint64_t>& sizes, uint64_t begin, uint64_t end)
+{
+    string data;
+    data.reserve(static_cast<size_t>(end - begin));
+    uint64_t offset = 0;
+    for (size_t i = 0; i < paths.size() && offset < end; offset += sizes[i], i++) {
+        uint64_t from = std::max(begin, offset);
+        uint64_t to = std::min(end, offset + sizes[i]);
+        if (from >= to) {
+            continue;
+        }
+        std::ifstream in(paths[i], std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(from - offset));
+        size_t old_size = data.size();
+        data.resize(old_size + static_cast<size_t>(to - from));
+        if (!in.read(&data[old_size], static_cast<std::streamsize>(to - from))) {
+            throw std::runtime_error("Cannot read input file: " + paths[i]);
+        }
+    }
+    return data;
+}
+
+// 本进程的部分再按线程分块，各块的状态映射按顺序组合
+StateMap MapLocally(const DfaTable& table, const string& data)
+{
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::min(hardware, std::max<size_t>(1, data.size() >> 20));
+    vector<StateMap> maps(chunks);
+    ParallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            size_t begin = data.size() * c / chunks;
+            size_t end = data.size() * (c + 1) / chunks;
+            maps[c] = ComputeStateMap(table, std::string_view(data).substr(begin, end - begin), true);
+        }
+    });
+    StateMap map = std::move(maps[0]);
+    for (size_t c = 1; c < chunks; c++) {
+        map = Compose(map, maps[c]);
+    }
+    return map;
+}
+
+int Run(const Options& options, int rank, int num_ranks)
+{
+    Automaton dfa = LoadDfa(options);
+    const DfaTable& table = dfa.GetTable();
+
+    // 每个进程自己取文件大小，避免额外通信；各进程看到的应当一致
+    vector<uint64_t> sizes;
+    uint64_t total = 0;
+    for (const auto& path : options.inputs) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("Cannot open input file: " + path);
+        }
+        sizes.push_back(static_cast<uint64_t>(in.tellg()));
+        total += sizes.back();
+    }
+    const uint64_t begin = total * static_cast<uint64_t>(rank) / static_cast<uint64_t>(num_ranks);
+    const uint64_t end = total * static_cast<uint64_t>(rank + 1) / static_cast<uint64_t>(num_ranks);
+
+    double start_time = MPI_Wtime();
+    string data = ReadRange(options.inputs, sizes, begin, end);
+    StateMap local = MapLocally(table, data);
+    vector<uint64_t> packed = Pack(local);
+
+    MPI_Datatype map_type;
+    MPI_Type_contiguous(static_cast<int>(packed.size()), MPI_UINT64_T, &map_type);
+    MPI_Type_commit(&map_type);
+    MPI_Op compose;
+    MPI_Op_create(&ComposePacked, 0, &compose);
+
+    vector<uint64_t> global(rank == 0 ? packed.size() : 0);
+    MPI_Reduce(packed.data(), global.data(), 1, map_type, compose, 0, MPI_COMM_WORLD);
+    MPI_Op_free(&compose);
+    MPI_Type_free(&map_type);
+    double elapsed = MPI_Wtime() - start_time;
+
+    if (rank == 0) {
+        const size_t q = table.start / table.stride;
+        DfaTable::StateId row = static_cast<DfaTable::StateId>(global[2 + q]);
+        uint64_t matches = global[2 + local.to.size() + q];
+        const char* verdict = row == DfaTable::kInvalidRow ? "invalid symbol"
+                              : table.IsAccepting(row) ? "accepted" : "rejected";
+        std::printf("bytes %llu  ranks %d\n", static_cast<unsigned long long>(total), num_ranks);
+        if (row == DfaTable::kInvalidRow) {
+            std::printf("final state -  %s\n", verdict);
+        } else {
+            std::printf("final state %u  %s\n", table.StateOf(row), verdict);
+        }
+        std::printf("accepted prefixes %llu\n", static_cast<unsigned long long>(matches));
+        std::printf("%.3f s  %.1f MB/s\n", elapsed, static_cast<double>(total) / std::max(elapsed, 1e-9) / 1e6);
+    }
+    return 0;
+}
+
+} // namespace
+
+// 把所有输入文件依次拼接成一个单词，按字节均分给各进程；每个进程计算自己部分的
+// 状态映射，再在MPI中按进程顺序归约，得到整体的最终状态和被接受的前缀数
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    int num_ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    Options options;
+    int i = 1;
+    if (i < argc && std::strcmp(argv[i], "-b") == 0) {
+        options.binary = true;
+        i++;
+    }
+    if (argc - i < 2) {
+        if (rank == 0) {
+            std::fprintf(stderr,
+                "usage: mpirun -np N %s [-b] <dfa-file> <input-file...>\n"
+                "Reads the input files, concatenated, as one word split across the ranks.\n"
+                "  -b        the DFA file is a binary image\n", argv[0]);
+        }
+        MPI_Finalize();
+        return 2;
+    }
+    options.dfa_path = argv[i++];
+    options.inputs.assign(argv + i, argv + argc);
+
+    int status = 0;
+    try {
+        status = Run(options, rank, num_ranks);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "rank %d: error: %s\n", rank, e.what());
+        MPI_Abort(MPI_COMM_WORLD, 2);
+    }
+    MPI_Finalize();
+    return status;
+}
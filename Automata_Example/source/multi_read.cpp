@@ -0,0 +1,207 @@
+#include "multi_read.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using std::vector;
+using std::string_view;
+using StateId = DfaTable::StateId;
+
+namespace {
+
+// Lanes are re-examined at least this often, so a lane stuck in a sink
+// gives up its slot soon instead of walking to the end of its word
+constexpr size_t kMaxBlock = 64;
+
+// Lane bookkeeping shared by the scalar and gather kernels. An idle lane reads
+// one padding byte forever (its step is 0) and sits in the sentinel row, which
+// never changes, so the kernels need no per-lane checks.
+template <size_t K>
+class Lanes
+{
+public:
+    Lanes(const DfaTable& table, const vector<string_view>& words, ReadResult* results)
+        : table(table), words(words), results(results)
+    {
+        for (size_t k = 0; k < K; k++) {
+            Load(k);
+        }
+    }
+
+    // Length of the next block every active lane can take without a check, 0 when all are idle
+    size_t BlockLength() const
+    {
+        size_t block = kMaxBlock;
+        bool any = false;
+        for (size_t k = 0; k < K; k++) {
+            if (word[k] != kIdle) {
+                block = std::min(block, left[k]);
+                any = true;
+            }
+        }
+        return any ? block : 0;
+    }
+
+    // Accounts for `block` steps, then retires and refills lanes that are done
+    void Advance(size_t block)
+    {
+        for (size_t k = 0; k < K; k++) {
+            if (word[k] == kIdle) {
+                continue;
+            }
+            left[k] -= block;
+            if (left[k] == 0 || row[k] < table.special_end) {
+                Finish(k);
+                Load(k);
+            }
+        }
+    }
+
+    const unsigned char* pos[K];
+    size_t step[K];
+    StateId row[K];
+
+private:
+    static constexpr size_t kIdle = std::numeric_limits<size_t>::max();
+    static constexpr unsigned char kPadding = 0;
+
+    const DfaTable& table;
+    const vector<string_view>& words;
+    ReadResult* results;
+    size_t next_word = 0;
+    size_t word[K];
+    size_t left[K];
+
+    void Finish(size_t k)
+    {
+        StateId r = row[k];
+        results[word[k]] = r == DfaTable::kInvalidRow ? ReadResult::InvalidSymbol
+                         : table.IsAccepting(r)      ? ReadResult::Accepted
+                                                     : ReadResult::Rejected;
+    }
+
+    // Words that need no stepping are decided on the spot
+    void Load(size_t k)
+    {
+        while (next_word < words.size()) {
+            size_t i = next_word++;
+            if (words[i].empty() || table.start < table.special_end) {
+                word[k] = i;
+                row[k] = table.start;
+                Finish(k);
+                continue;
+            }
+            word[k] = i;
+            pos[k] = reinterpret_cast<const unsigned char*>(words[i].data());
+            step[k] = 1;
+            left[k] = words[i].size();
+            row[k] = table.start;
+            return;
+        }
+        word[k] = kIdle;
+        pos[k] = &kPadding;
+        step[k] = 0;
+        left[k] = 0;
+        row[k] = DfaTable::kInvalidRow;
+    }
+};
+
+template <size_t K>
+void ScalarKernel(const DfaTable& table, const vector<string_view>& words, ReadResult* results)
+{
+    const StateId* next = table.next.data();
+    const std::uint16_t* columns = table.column_of.data();
+    const StateId special_end = table.special_end;
+
+    Lanes<K> lanes(table, words, results);
+    while (size_t block = lanes.BlockLength()) {
+        for (size_t i = 0; i < block; i++) {
+            for (size_t k = 0; k < K; k++) {
+                // 进入特殊状态的通道保持不动，与Read的提前退出一致
+                StateId r = lanes.row[k];
+                StateId to = next[r + columns[*lanes.pos[k]]];
+                lanes.row[k] = r >= special_end ? to : r;
+                lanes.pos[k] += lanes.step[k];
+            }
+        }
+        lanes.Advance(block);
+    }
+}
+
+#ifdef __AVX2__
+// K is 8 or 16: one or two vectors of rows, each step a gather from `next`
+template <size_t K>
+void GatherKernel(const DfaTable& table, const vector<string_view>& words, ReadResult* results)
+{
+    constexpr size_t V = K / 8;
+    const int* next = reinterpret_cast<const int*>(table.next.data());
+    const std::uint16_t* columns = table.column_of.data();
+    // Unsigned r >= special_end is max(r, special_end) == r
+    const __m256i special = _mm256_set1_epi32(static_cast<int>(table.special_end));
+
+    Lanes<K> lanes(table, words, results);
+    while (size_t block = lanes.BlockLength()) {
+        __m256i rows[V];
+        for (size_t v = 0; v < V; v++) {
+            rows[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.row + 8 * v));
+        }
+        for (size_t i = 0; i < block; i++) {
+            alignas(32) std::uint32_t cols[K];
+            for (size_t k = 0; k < K; k++) {
+                cols[k] = columns[*lanes.pos[k]];
+                lanes.pos[k] += lanes.step[k];
+            }
+            for (size_t v = 0; v < V; v++) {
+                __m256i index = _mm256_add_epi32(rows[v], _mm256_load_si256(reinterpret_cast<const __m256i*>(cols + 8 * v)));
+                __m256i to = _mm256_i32gather_epi32(next, index, 4);
+                __m256i active = _mm256_cmpeq_epi32(_mm256_max_epu32(rows[v], special), rows[v]);
+                rows[v] = _mm256_blendv_epi8(rows[v], to, active);
+            }
+        }
+        for (size_t v = 0; v < V; v++) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.row + 8 * v), rows[v]);
+        }
+        lanes.Advance(block);
+    }
+}
+#endif
+
+} // namespace
+
+void ReadMany(const Automaton& dfa, const vector<string_view>& words, vector<ReadResult>& results, size_t lanes)
+{
+    if (lanes == 0 || lanes > 16) {
+        throw std::invalid_argument("Lane count must be between 1 and 16");
+    }
+    const DfaTable& table = dfa.GetTable();
+    results.resize(words.size());
+    ReadResult* out = results.data();
+
+    // Rounded once, so the gather and scalar kernels run the same lane counts
+    lanes = lanes == 1 ? 1 : lanes <= 4 ? 4 : lanes <= 8 ? 8 : 16;
+
+#ifdef __AVX2__
+    // Gather indices are signed 32-bit
+    if (lanes >= 8 && table.next.size() <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+        if (lanes == 16) {
+            GatherKernel<16>(table, words, out);
+        } else {
+            GatherKernel<8>(table, words, out);
+        }
+        return;
+    }
+#endif
+
+    if (lanes == 1) {
+        ScalarKernel<1>(table, words, out);
+    } else if (lanes == 4) {
+        ScalarKernel<4>(table, words, out);
+    } else if (lanes == 8) {
+        ScalarKernel<8>(table, words, out);
+    } else {
+        ScalarKernel<16>(table, words, out);
+    }
+}
@@ -0,0 +1,208 @@
+#include "prefix_cache.h"
+#include <algorithm>
+#include <stdexcept>
+
+using std::string;
+using std::string_view;
+using StateId = DfaTable::StateId;
+
+PrefixCache::PrefixCache(const Automaton& dfa, size_t max_bytes, size_t granularity)
+    : dfa(dfa), granularity(granularity)
+{
+    if (granularity == 0) {
+        throw std::invalid_argument("Prefix cache granularity must be positive");
+    }
+    // 每个检查点：节点本身、它的字节，以及哈希表中的两个槽位
+    const size_t per_node = sizeof(Node) + granularity + 2 * sizeof(uint32_t);
+    max_nodes = std::max<size_t>(1, std::min<size_t>(max_bytes / per_node, kNone - 1));
+    size_t num_buckets = 1;
+    while (num_buckets < 2 * max_nodes) {
+        num_buckets *= 2;
+    }
+    buckets.assign(num_buckets, kNone);
+    Clear();
+}
+
+void PrefixCache::Clear()
+{
+    nodes.assign(1, Node());
+    nodes[0].row = dfa.GetTable().start;
+    keys.assign(granularity, '\0');
+    free_nodes.clear();
+    std::fill(buckets.begin(), buckets.end(), kNone);
+    newest = kNone;
+    oldest = kNone;
+}
+
+uint64_t PrefixCache::Hash(uint32_t parent, string_view chunk) const
+{
+    // FNV-1a，以父节点编号作为种子
+    uint64_t h = 14695981039346656037ULL ^ (uint64_t{parent} * 0x9E3779B97F4A7C15ULL);
+    for (char c : chunk) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+uint32_t PrefixCache::Find(uint32_t parent, string_view chunk, uint64_t hash) const
+{
+    const size_t mask = buckets.size() - 1;
+    for (size_t i = hash & mask; buckets[i] != kNone; i = (i + 1) & mask) {
+        const Node& node = nodes[buckets[i]];
+        if (node.hash == hash && node.parent == parent &&
+            keys.compare(buckets[i] * granularity, granularity, chunk) == 0) {
+            return buckets[i];
+        }
+    }
+    return kNone;
+}
+
+uint32_t PrefixCache::Add(uint32_t parent, string_view chunk, uint64_t hash, StateId row)
+{
+    if (GetNumEntries() >= max_nodes) {
+        EvictOne();
+        if (GetNumEntries() >= max_nodes) {
+            return kNone;  // 所有节点都在当前路径上
+        }
+    }
+    uint32_t id;
+    if (!free_nodes.empty()) {
+        id = free_nodes.back();
+        free_nodes.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        keys.resize(keys.size() + granularity);
+    }
+    Node& node = nodes[id];
+    node = Node();
+    node.hash = hash;
+    node.row = row;
+    node.parent = parent;
+    node.epoch = epoch;
+    keys.replace(id * granularity, granularity, chunk);
+    nodes[parent].children++;
+
+    const size_t mask = buckets.size() - 1;
+    size_t i = hash & mask;
+    while (buckets[i] != kNone) {
+        i = (i + 1) & mask;
+    }
+    buckets[i] = id;
+    PushNewest(id);
+    return id;
+}
+
+void PrefixCache::EvictOne()
+{
+    // 最旧的节点一定是叶子；当前读取路径上的节点跳过
+    uint32_t id = oldest;
+    while (id != kNone && (nodes[id].epoch == epoch || nodes[id].children > 0)) {
+        id = nodes[id].newer;
+    }
+    if (id == kNone) {
+        return;
+    }
+    Unlink(id);
+    EraseBucket(id);
+    nodes[nodes[id].parent].children--;
+    free_nodes.push_back(id);
+    stats.evictions++;
+}
+
+void PrefixCache::EraseBucket(uint32_t id)
+{
+    const size_t mask = buckets.size() - 1;
+    size_t i = nodes[id].hash & mask;
+    while (buckets[i] != id) {
+        i = (i + 1) & mask;
+    }
+    // 线性探测的反向移位删除：把后面不在自己理想位置的条目前移
+    for (size_t j = (i + 1) & mask; buckets[j] != kNone; j = (j + 1) & mask) {
+        size_t home = nodes[buckets[j]].hash & mask;
+        bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            buckets[i] = buckets[j];
+            i = j;
+        }
+    }
+    buckets[i] = kNone;
+}
+
+void PrefixCache::Unlink(uint32_t id)
+{
+    Node& node = nodes[id];
+    (node.newer == kNone ? newest : nodes[node.newer].older) = node.older;
+    (node.older == kNone ? oldest : nodes[node.older].newer) = node.newer;
+    node.newer = kNone;
+    node.older = kNone;
+}
+
+void PrefixCache::PushNewest(uint32_t id)
+{
+    Node& node = nodes[id];
+    node.newer = kNone;
+    node.older = newest;
+    if (newest != kNone) {
+        nodes[newest].newer = id;
+    } else {
+        oldest = id;
+    }
+    newest = id;
+}
+
+bool PrefixCache::Read(string_view word)
+{
+    const DfaTable& table = dfa.GetTable();
+    stats.reads++;
+    stats.bytes_read += word.size();
+    epoch++;
+
+    // 沿已缓存的检查点前进
+    uint32_t node = 0;
+    size_t pos = 0;
+    path.clear();
+    while (pos + granularity <= word.size()) {
+        string_view chunk = word.substr(pos, granularity);
+        uint32_t child = Find(node, chunk, Hash(node, chunk));
+        if (child == kNone) {
+            break;
+        }
+        node = child;
+        nodes[node].epoch = epoch;
+        path.push_back(node);
+        pos += granularity;
+    }
+    StateId row = nodes[node].row;
+    if (pos > 0) {
+        stats.hits++;
+        stats.bytes_skipped += pos;
+    }
+
+    // 继续读取，每个完整的块之后新建一个检查点；进入特殊行后不再需要
+    while (pos + granularity <= word.size() && row >= table.special_end) {
+        string_view chunk = word.substr(pos, granularity);
+        table.Run(row, chunk.data(), chunk.data() + chunk.size());
+        uint32_t child = Add(node, chunk, Hash(node, chunk), row);
+        if (child == kNone) {
+            pos += granularity;
+            break;
+        }
+        node = child;
+        path.push_back(node);
+        pos += granularity;
+    }
+    table.Run(row, word.data() + pos, word.data() + word.size());
+
+    // 从最深处向根依次标为最新，保持父节点比子节点新
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        Unlink(*it);
+        PushNewest(*it);
+    }
+
+    if (row == DfaTable::kInvalidRow) {
+        // 错误信息与Read完全一致
+        return dfa.Read(string(word));
+    }
+    return table.IsAccepting(row);
+}
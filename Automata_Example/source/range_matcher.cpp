@@ -0,0 +1,121 @@
+#include "range_matcher.h"
+#include "parallel_for.h"
+#include "state_map.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using std::vector;
+using std::string_view;
+using StateId = DfaTable::StateId;
+
+namespace {
+
+// 块再小时树节点比直接扫描还慢
+constexpr size_t kMinBlockSize = 64;
+
+} // namespace
+
+RangeMatcher::RangeMatcher(const Automaton& dfa, string_view buffer, size_t memory_budget)
+    : dfa(dfa), buffer(buffer)
+{
+    const DfaTable& table = this->dfa.GetTable();
+    num_rows = table.next.size() / table.stride;
+
+    // 约2 * 块数个节点，每个节点num_rows个条目，按预算选出最小的块长
+    const size_t bytes_per_block = 2 * num_rows * sizeof(StateId);
+    const size_t max_blocks = std::max<size_t>(1, memory_budget / bytes_per_block);
+    block_size = std::max(kMinBlockSize, (buffer.size() + max_blocks - 1) / max_blocks);
+    num_blocks = std::max<size_t>(1, (buffer.size() + block_size - 1) / block_size);
+    maps.resize((2 * num_blocks - 1) * num_rows);
+
+    ParallelFor(num_blocks, 64, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; k++) {
+            string_view block = buffer.substr(std::min(buffer.size(), k * block_size), block_size);
+            StateMap map = ComputeStateMap(table, block);
+            std::copy(map.to.begin(), map.to.end(), maps.begin() + static_cast<std::ptrdiff_t>((num_blocks + k - 1) * num_rows));
+        }
+    });
+
+    // 节点i的子节点编号都大于i，按编号区间[2^k, 2^(k+1))自底向上逐层并行组合
+    size_t level = 1;
+    while (level * 2 < num_blocks) {
+        level *= 2;
+    }
+    for (; level >= 1; level /= 2) {
+        const size_t first_node = level;
+        const size_t last_node = std::min(num_blocks, 2 * level);
+        if (first_node >= last_node) {
+            continue;
+        }
+        // 每个线程至少组合约64K个条目
+        ParallelFor(last_node - first_node, std::max<size_t>(1, (size_t{1} << 16) / num_rows),
+                    [&](size_t first, size_t last) {
+            for (size_t node = first_node + first; node < first_node + last; node++) {
+                const StateId* left = MapOf(2 * node);
+                const StateId* right = MapOf(2 * node + 1);
+                StateId* out = maps.data() + (node - 1) * num_rows;
+                for (size_t q = 0; q < num_rows; q++) {
+                    out[q] = right[left[q] / table.stride];
+                }
+            }
+        });
+    }
+}
+
+StateId RangeMatcher::Scan(const DfaTable& table, StateId row, size_t begin, size_t end) const
+{
+    table.Run(row, buffer.data() + begin, buffer.data() + end);
+    return row;
+}
+
+ReadResult RangeMatcher::Query(size_t begin, size_t end) const
+{
+    if (begin > end || end > buffer.size()) {
+        throw std::invalid_argument("Invalid range [" + std::to_string(begin) + ", " + std::to_string(end) +
+                                    ") for a buffer of " + std::to_string(buffer.size()) + " bytes");
+    }
+    const DfaTable& table = dfa.GetTable();
+    StateId row = table.start;
+
+    // 两端不完整的块直接扫描，中间的完整块用树节点跨过
+    size_t first_block = (begin + block_size - 1) / block_size;
+    size_t last_block = end / block_size;
+    if (first_block >= last_block) {
+        row = Scan(table, row, begin, end);
+    } else {
+        row = Scan(table, row, begin, first_block * block_size);
+
+        // 左侧节点按顺序应用；右侧节点从右向左收集，最后倒序应用
+        const StateId* right_nodes[64];
+        size_t num_right = 0;
+        for (size_t l = first_block + num_blocks, r = last_block + num_blocks; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                row = MapOf(l++)[row / table.stride];
+            }
+            if (r & 1) {
+                right_nodes[num_right++] = MapOf(--r);
+            }
+        }
+        while (num_right > 0) {
+            row = right_nodes[--num_right][row / table.stride];
+        }
+
+        row = Scan(table, row, last_block * block_size, end);
+    }
+
+    if (row == DfaTable::kInvalidRow) {
+        return ReadResult::InvalidSymbol;
+    }
+    return table.IsAccepting(row) ? ReadResult::Accepted : ReadResult::Rejected;
+}
+
+void RangeMatcher::QueryMany(const vector<std::pair<size_t, size_t>>& ranges, vector<ReadResult>& results) const
+{
+    results.resize(ranges.size());
+    ParallelFor(ranges.size(), 1024, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            results[i] = Query(ranges[i].first, ranges[i].second);
+        }
+    });
+}
@@ -0,0 +1,71 @@
+#include "automaton_io.h"
+#include "trace.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using std::string;
+
+namespace {
+
+string ReadWholeFile(const string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open input file: " + path);
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+int Usage(const char* program)
+{
+    std::fprintf(stderr,
+        "usage: %s record <dfa-file> <word-file> <trace-file>\n"
+        "       %s replay <dfa-file> <word-file> <trace-file>\n", program, program);
+    return 2;
+}
+
+} // namespace
+
+// 记录一个单词的状态路径，或重新执行并与已记录的路径比较
+int main(int argc, char** argv)
+{
+    if (argc != 5) {
+        return Usage(argv[0]);
+    }
+
+    try {
+        Automaton dfa = LoadAutomatonFile(argv[2]);
+        string word = ReadWholeFile(argv[3]);
+
+        if (std::strcmp(argv[1], "record") == 0) {
+            TraceLog log = RecordTrace(dfa, word);
+            log.WriteFile(argv[4]);
+            std::printf("recorded %zu states (%zu bytes)\n", log.Size(), log.Bytes().size());
+            return 0;
+        }
+        if (std::strcmp(argv[1], "replay") != 0) {
+            return Usage(argv[0]);
+        }
+
+        TraceDiff diff = ReplayTrace(dfa, word, TraceLog::ReadFile(argv[4]));
+        if (diff.identical) {
+            std::printf("trace matches (%zu states)\n", word.size() + 1);
+            return 0;
+        }
+
+        auto describe = [](uint32_t state) {
+            return state == TraceDiff::kNoState ? string("<end of trace>") : std::to_string(state);
+        };
+        std::printf("trace differs at step %zu: recorded %s, replayed %s\n",
+                    diff.position, describe(diff.expected).c_str(), describe(diff.actual).c_str());
+        return 1;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,216 @@
+#include "result_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using std::string_view;
+
+namespace {
+
+constexpr size_t kMaxShards = 64;
+// 每个分片至少这么多槽位，否则时钟算法的近似太粗
+constexpr size_t kMinSlotsPerShard = 256;
+
+// 每次处理8个字节的乘法混合哈希，不需要抗碰撞，只要快且分布均匀
+uint64_t HashBytes(string_view bytes)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (bytes.size() * 0xFF51AFD7ED558CCDULL);
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t v;
+        std::memcpy(&v, bytes.data() + i, 8);
+        h = (h ^ v) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    if (i < bytes.size()) {
+        uint64_t v = 0;
+        std::memcpy(&v, bytes.data() + i, bytes.size() - i);
+        h = (h ^ v) * 0x94D049BB133111EBULL;
+        h ^= h >> 29;
+    }
+    h *= 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+}
+
+} // namespace
+
+ResultCache::ResultCache(const Automaton& dfa, size_t max_bytes, size_t max_word_length)
+    : dfa(dfa), max_word_length(max_word_length)
+{
+    if (max_word_length > UINT16_MAX) {
+        throw std::invalid_argument("Cached words are limited to 65535 bytes");
+    }
+    // 每个槽位：槽位本身、内联的键，以及索引中的两个位置
+    const size_t per_slot = sizeof(Slot) + max_word_length + 2 * sizeof(uint32_t);
+    const size_t total_slots = std::max<size_t>(1, max_bytes / per_slot);
+    size_t num_shards = 1;
+    while (num_shards * 2 <= kMaxShards && num_shards * 2 * kMinSlotsPerShard <= total_slots) {
+        num_shards *= 2;
+    }
+    slots_per_shard = std::min<size_t>(total_slots / num_shards, kEmpty - 1);
+    size_t index_size = 1;
+    while (index_size < 2 * slots_per_shard) {
+        index_size *= 2;
+    }
+
+    for (size_t i = 0; i < num_shards; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->slots.resize(slots_per_shard);
+        shard->keys.resize(slots_per_shard * max_word_length);
+        shard->index.assign(index_size, kEmpty);
+        shards.push_back(std::move(shard));
+    }
+}
+
+ReadResult ResultCache::Compute(string_view word, uint32_t& state) const
+{
+    const DfaTable& table = dfa.GetTable();
+    DfaTable::StateId row = table.start;
+    table.Run(row, word.data(), word.data() + word.size());
+    if (row == DfaTable::kInvalidRow) {
+        return ReadResult::InvalidSymbol;
+    }
+    state = table.StateOf(row);
+    return table.IsAccepting(row) ? ReadResult::Accepted : ReadResult::Rejected;
+}
+
+uint32_t ResultCache::Find(const Shard& shard, string_view word, uint64_t hash) const
+{
+    const size_t mask = shard.index.size() - 1;
+    for (size_t i = hash & mask; shard.index[i] != kEmpty; i = (i + 1) & mask) {
+        uint32_t id = shard.index[i];
+        const Slot& slot = shard.slots[id];
+        if (slot.hash == hash && slot.length == word.size() &&
+            (word.empty() || std::memcmp(shard.keys.data() + id * max_word_length, word.data(), word.size()) == 0)) {
+            return id;
+        }
+    }
+    return kEmpty;
+}
+
+uint32_t ResultCache::Claim(Shard& shard)
+{
+    // 时钟算法：被引用过的槽位清掉标记再给一次机会，最多转两圈
+    while (true) {
+        uint32_t id = static_cast<uint32_t>(shard.hand);
+        shard.hand = shard.hand + 1 == shard.slots.size() ? 0 : shard.hand + 1;
+        Slot& slot = shard.slots[id];
+        if (!slot.used) {
+            return id;
+        }
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        EraseIndex(shard, id);
+        slot.used = false;
+        shard.stats.evictions++;
+        return id;
+    }
+}
+
+void ResultCache::EraseIndex(Shard& shard, uint32_t slot)
+{
+    const size_t mask = shard.index.size() - 1;
+    size_t i = shard.slots[slot].hash & mask;
+    while (shard.index[i] != slot) {
+        i = (i + 1) & mask;
+    }
+    // 线性探测的反向移位删除
+    for (size_t j = (i + 1) & mask; shard.index[j] != kEmpty; j = (j + 1) & mask) {
+        size_t home = shard.slots[shard.index[j]].hash & mask;
+        bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            shard.index[i] = shard.index[j];
+            i = j;
+        }
+    }
+    shard.index[i] = kEmpty;
+}
+
+ReadResult ResultCache::Read(string_view word, uint32_t* final_state)
+{
+    uint32_t state = 0;
+    const uint64_t hash = HashBytes(word);
+    Shard& shard = *shards[(hash >> 58) & (shards.size() - 1)];
+
+    if (word.size() > max_word_length) {
+        ReadResult result = Compute(word, state);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.stats.bypassed++;
+        }
+        if (final_state != nullptr && result != ReadResult::InvalidSymbol) {
+            *final_state = state;
+        }
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        uint32_t id = Find(shard, word, hash);
+        if (id != kEmpty) {
+            Slot& slot = shard.slots[id];
+            slot.referenced = true;
+            shard.stats.hits++;
+            if (final_state != nullptr && slot.result != ReadResult::InvalidSymbol) {
+                *final_state = slot.state;
+            }
+            return slot.result;
+        }
+        shard.stats.misses++;
+    }
+
+    // 计算时不持有锁；期间其他线程可能已插入同一个词，插入前再查一次
+    ReadResult result = Compute(word, state);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (Find(shard, word, hash) == kEmpty) {
+            uint32_t id = Claim(shard);
+            Slot& slot = shard.slots[id];
+            slot.hash = hash;
+            slot.state = state;
+            slot.length = static_cast<uint16_t>(word.size());
+            slot.result = result;
+            slot.referenced = false;
+            slot.used = true;
+            if (!word.empty()) {
+                std::memcpy(shard.keys.data() + id * max_word_length, word.data(), word.size());
+            }
+            const size_t mask = shard.index.size() - 1;
+            size_t i = hash & mask;
+            while (shard.index[i] != kEmpty) {
+                i = (i + 1) & mask;
+            }
+            shard.index[i] = id;
+        }
+    }
+    if (final_state != nullptr && result != ReadResult::InvalidSymbol) {
+        *final_state = state;
+    }
+    return result;
+}
+
+ResultCache::Stats ResultCache::GetStats() const
+{
+    Stats total;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->stats.hits;
+        total.misses += shard->stats.misses;
+        total.bypassed += shard->stats.bypassed;
+        total.evictions += shard->stats.evictions;
+    }
+    return total;
+}
+
+void ResultCache::Clear()
+{
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        std::fill(shard->slots.begin(), shard->slots.end(), Slot());
+        std::fill(shard->index.begin(), shard->index.end(), kEmpty);
+        shard->hand = 0;
+        shard->stats = Stats();
+    }
+}
@@ -0,0 +1,231 @@
+#include "search.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+// Subset construction: every distinct set of original states becomes one
+// state of `out`; the empty set is the dead state -1.
+template <typename Dfa, typename StepFn, typename AcceptFn>
+void BuildSubsetDfa(Dfa& out, vector<int> start_set, size_t num_columns, StepFn step, AcceptFn accept)
+{
+    std::map<vector<int>, int> ids;
+    vector<vector<int>> sets;
+
+    auto intern = [&](vector<int> set) {
+        if (set.empty()) {
+            return -1;
+        }
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+        auto it = ids.find(set);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        int id = static_cast<int>(sets.size());
+        ids.emplace(set, id);
+        sets.push_back(std::move(set));
+        return id;
+    };
+
+    out.start = intern(std::move(start_set));
+    for (size_t k = 0; k < sets.size(); k++) {
+        vector<int> current = sets[k];
+        for (size_t col = 0; col < num_columns; col++) {
+            out.next.push_back(intern(step(current, col)));
+        }
+        out.accepting.push_back(accept(current));
+    }
+}
+
+} // namespace
+
+Searcher::Searcher(const Automaton& dfa)
+    : num_columns(dfa.GetNumColumns())
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    const int q0 = dfa.GetInitialState();
+    vector<bool> accepting(M.size(), false);
+    for (int s : dfa.GetAcceptingStates()) {
+        accepting[static_cast<size_t>(s)] = true;
+    }
+    vector<bool> live(M.size());
+    for (size_t i = 0; i < M.size(); i++) {
+        live[i] = !dfa.IsDeadState(static_cast<int>(i));
+    }
+
+    for (unsigned b = 0; b < 256; b++) {
+        column_of[b] = dfa.GetByteClasses().ColumnOf(static_cast<char>(b));
+    }
+
+    auto any_accepting = [&](const vector<int>& set) {
+        return std::any_of(set.begin(), set.end(), [&](int q) { return accepting[static_cast<size_t>(q)]; });
+    };
+
+    // Sigma* L: the initial state stays in every set, which is the self-loop prefix
+    BuildSubsetDfa(forward, {q0}, num_columns,
+        [&](const vector<int>& set, size_t col) {
+            vector<int> next{q0};
+            for (int q : set) {
+                int target = M[static_cast<size_t>(q)][col];
+                if (live[static_cast<size_t>(target)]) {
+                    next.push_back(target);
+                }
+            }
+            return next;
+        },
+        any_accepting);
+
+    // Reversed prefixes of L: start from every live state, walk edges backwards,
+    // accept once the initial state has been reached
+    vector<vector<vector<int>>> predecessors(num_columns, vector<vector<int>>(M.size()));
+    vector<int> live_states;
+    for (size_t p = 0; p < M.size(); p++) {
+        if (!live[p]) {
+            continue;
+        }
+        live_states.push_back(static_cast<int>(p));
+        for (size_t col = 0; col < num_columns; col++) {
+            predecessors[col][static_cast<size_t>(M[p][col])].push_back(static_cast<int>(p));
+        }
+    }
+    BuildSubsetDfa(reverse, live_states, num_columns,
+        [&](const vector<int>& set, size_t col) {
+            vector<int> next;
+            for (int q : set) {
+                const auto& from = predecessors[col][static_cast<size_t>(q)];
+                next.insert(next.end(), from.begin(), from.end());
+            }
+            return next;
+        },
+        [&](const vector<int>& set) { return std::find(set.begin(), set.end(), q0) != set.end(); });
+
+    // The original DFA with dead states cut off so a failed extension stops early
+    anchored.start = live[static_cast<size_t>(q0)] ? q0 : -1;
+    for (size_t i = 0; i < M.size(); i++) {
+        for (int target : M[i]) {
+            anchored.next.push_back(live[static_cast<size_t>(target)] ? target : -1);
+        }
+        anchored.accepting.push_back(accepting[i]);
+    }
+}
+
+std::optional<Match> Searcher::Find(const string& text, size_t from) const
+{
+    if (from > text.size()) {
+        return std::nullopt;
+    }
+
+    // 1. Single forward pass for the earliest position where a match ends
+    int state = forward.start;
+    bool found = forward.accepting[static_cast<size_t>(state)];
+    size_t end = from;
+    for (size_t i = from; !found && i < text.size(); i++) {
+        int col = Column(text[i]);
+        state = col < 0 ? forward.start : forward.Step(state, col, num_columns);
+        if (forward.accepting[static_cast<size_t>(state)]) {
+            found = true;
+            end = i + 1;
+        }
+    }
+    if (!found) {
+        return std::nullopt;
+    }
+
+    // 2. Walk backwards from that end, collecting positions where a match may start
+    vector<size_t> candidates;
+    int r = reverse.start;
+    for (size_t pos = end; r >= 0; pos--) {
+        if (reverse.accepting[static_cast<size_t>(r)]) {
+            candidates.push_back(pos);
+        }
+        if (pos == from) {
+            break;
+        }
+        int col = Column(text[pos - 1]);
+        r = col < 0 ? -1 : reverse.Step(r, col, num_columns);
+    }
+    if (candidates.empty()) {
+        return std::nullopt;
+    }
+
+    // 3. One forward scan from the leftmost candidate, running every candidate
+    //    start in lockstep. Starts that reach the same state share their future,
+    //    so only the leftmost of them is kept, which bounds the threads by the
+    //    number of states. Once a thread accepts, threads that started later can
+    //    no longer win; earlier ones keep running in case they accept further on.
+    struct Thread
+    {
+        int state;
+        size_t start;
+    };
+    vector<Thread> threads;  // ordered by start
+    vector<Thread> stepped;
+    // 只有一个候选时不会出现重复状态，也就不必为每次查找分配按状态的数组
+    vector<size_t> seen_at(candidates.size() > 1 ? anchored.accepting.size() : 0, SIZE_MAX);
+    auto claim = [&](int q, size_t pos) {
+        if (seen_at.empty()) {
+            return true;
+        }
+        if (seen_at[static_cast<size_t>(q)] == pos) {
+            return false;
+        }
+        seen_at[static_cast<size_t>(q)] = pos;
+        return true;
+    };
+    std::optional<Match> best;
+    size_t next_candidate = candidates.size();  // candidates are in decreasing order
+    for (size_t pos = candidates.back(); ; pos++) {
+        // 还没有匹配时，才值得从更靠右的候选位置开始新线程
+        if (next_candidate > 0 && candidates[next_candidate - 1] == pos) {
+            next_candidate--;
+            if (!best && anchored.start >= 0 && claim(anchored.start, pos)) {
+                threads.push_back(Thread{anchored.start, pos});
+            }
+        }
+        for (size_t t = 0; t < threads.size(); t++) {
+            if (anchored.accepting[static_cast<size_t>(threads[t].state)]) {
+                best = Match{threads[t].start, pos};
+                threads.resize(t + 1);
+                break;
+            }
+        }
+        if (threads.empty()) {
+            if (best || next_candidate == 0) {
+                break;
+            }
+            pos = candidates[next_candidate - 1] - 1;  // 跳到下一个候选位置
+            continue;
+        }
+        if (pos == text.size()) {
+            break;
+        }
+
+        int col = Column(text[pos]);
+        stepped.clear();
+        for (const Thread& thread : threads) {
+            int q = col < 0 ? -1 : anchored.Step(thread.state, col, num_columns);
+            if (q >= 0 && claim(q, pos + 1)) {
+                stepped.push_back(Thread{q, thread.start});
+            }
+        }
+        threads.swap(stepped);
+    }
+    return best;
+}
+
+std::vector<Match> Searcher::FindAll(const string& text) const
+{
+    vector<Match> matches;
+    size_t from = 0;
+    while (auto match = Find(text, from)) {
+        matches.push_back(*match);
+        // 空匹配之后必须前进一个字符，否则会停在原地
+        from = match->end > match->start ? match->end : match->end + 1;
+    }
+    return matches;
+}
@@ -0,0 +1,209 @@
+#include "state_map.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+using std::vector;
+using std::string_view;
+using StateId = DfaTable::StateId;
+
+namespace {
+
+constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+// 每读这么多字节检查一次哪些路径已经合并
+constexpr size_t kMergeInterval = 256;
+
+// 从单个起点读入，特殊行之后的字节不再读取
+ScanResult ScanFrom(const DfaTable& table, StateId row, string_view piece)
+{
+    ScanResult result;
+    size_t pos = 0;
+    for (; pos < piece.size() && row >= table.special_end; pos++) {
+        row = table.Step(row, static_cast<unsigned char>(piece[pos]));
+        result.matches += table.IsAccepting(row);
+    }
+    if (table.IsAccepting(row)) {
+        result.matches += piece.size() - pos;
+    }
+    result.row = row;
+    return result;
+}
+
+// 所有起点同时前进，每条仍然不同的路径占一个槽位。路径合并后不会再分开，
+// 所以只在不同路径数减半时才重新编号，重新编号总共只有O(log n)次
+template <bool kCount>
+StateMap Compute(const DfaTable& table, string_view piece)
+{
+    const StateId stride = table.stride;
+    const StateId special_end = table.special_end;
+    const size_t num_rows = table.next.size() / stride;
+
+    StateMap map;
+    map.stride = stride;
+    map.to.resize(num_rows);
+    if (kCount) {
+        map.matches.assign(num_rows, 0);
+    }
+
+    vector<uint32_t> slot_of(num_rows, kNoSlot);
+    vector<StateId> active;
+    for (size_t q = 0; q < num_rows; q++) {
+        StateId row = static_cast<StateId>(q) * stride;
+        map.to[q] = row;
+        if (row >= special_end) {
+            slot_of[q] = static_cast<uint32_t>(active.size());
+            active.push_back(row);
+        } else if (kCount && table.accepting[q]) {
+            map.matches[q] = piece.size();
+        }
+    }
+    vector<uint64_t> counts(kCount ? active.size() : 0);
+    vector<uint32_t> seen(num_rows, kNoSlot);
+
+    const StateId* next = table.next.data();
+    const std::uint16_t* columns = table.column_of.data();
+    size_t pos = 0;
+    while (!active.empty() && pos < piece.size()) {
+        const size_t block_end = std::min(piece.size(), pos + kMergeInterval);
+        for (; pos < block_end; pos++) {
+            const StateId column = columns[static_cast<unsigned char>(piece[pos])];
+            for (size_t s = 0; s < active.size(); s++) {
+                StateId r = active[s];
+                r = r < special_end ? r : next[r + column];
+                active[s] = r;
+                if (kCount) {
+                    counts[s] += table.accepting[r / stride];
+                }
+            }
+        }
+
+        uint32_t distinct = 0;
+        for (StateId r : active) {
+            if (r >= special_end && seen[r / stride] == kNoSlot) {
+                seen[r / stride] = distinct++;
+            }
+        }
+        if (size_t{distinct} * 2 <= active.size()) {
+            // 进入特殊行的路径在此结束，其余路径按合并后的编号重排
+            const uint64_t remaining = piece.size() - pos;
+            for (size_t q = 0; q < num_rows; q++) {
+                uint32_t s = slot_of[q];
+                if (s == kNoSlot) {
+                    continue;
+                }
+                StateId r = active[s];
+                if (kCount) {
+                    map.matches[q] += counts[s];
+                }
+                if (r < special_end) {
+                    map.to[q] = r;
+                    slot_of[q] = kNoSlot;
+                    if (kCount && table.accepting[r / stride]) {
+                        map.matches[q] += remaining;
+                    }
+                } else {
+                    slot_of[q] = seen[r / stride];
+                }
+            }
+            vector<StateId> merged(distinct);
+            for (StateId r : active) {
+                if (r >= special_end) {
+                    merged[seen[r / stride]] = r;
+                }
+            }
+            active.swap(merged);
+            if (kCount) {
+                counts.assign(active.size(), 0);
+            }
+            for (StateId r : active) {
+                seen[r / stride] = kNoSlot;
+            }
+        } else {
+            for (StateId r : active) {
+                if (r >= special_end) {
+                    seen[r / stride] = kNoSlot;
+                }
+            }
+        }
+    }
+
+    for (size_t q = 0; q < num_rows; q++) {
+        uint32_t s = slot_of[q];
+        if (s != kNoSlot) {
+            map.to[q] = active[s];
+            if (kCount) {
+                map.matches[q] += counts[s];
+            }
+        }
+    }
+    return map;
+}
+
+} // namespace
+
+StateMap StateMap::Identity(const DfaTable& table, bool count_matches)
+{
+    StateMap map;
+    map.stride = table.stride;
+    const size_t num_rows = table.next.size() / table.stride;
+    map.to.resize(num_rows);
+    for (size_t q = 0; q < num_rows; q++) {
+        map.to[q] = static_cast<StateId>(q) * table.stride;
+    }
+    if (count_matches) {
+        map.matches.assign(num_rows, 0);
+    }
+    return map;
+}
+
+StateMap ComputeStateMap(const DfaTable& table, string_view piece, bool count_matches)
+{
+    return count_matches ? Compute<true>(table, piece) : Compute<false>(table, piece);
+}
+
+StateMap Compose(const StateMap& first, const StateMap& second)
+{
+    StateMap map;
+    map.stride = first.stride;
+    map.to.resize(first.to.size());
+    const bool count = !first.matches.empty() && !second.matches.empty();
+    if (count) {
+        map.matches.resize(first.to.size());
+    }
+    for (size_t q = 0; q < first.to.size(); q++) {
+        StateId middle = first.to[q];
+        map.to[q] = second.Apply(middle);
+        if (count) {
+            map.matches[q] = first.matches[q] + second.MatchesFrom(middle);
+        }
+    }
+    return map;
+}
+
+ScanResult ScanParallel(const Automaton& dfa, string_view text, size_t min_chunk)
+{
+    const DfaTable& table = dfa.GetTable();
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::min(hardware, std::max<size_t>(1, text.size() / std::max<size_t>(1, min_chunk)));
+
+    // 第一块只需要从初始状态读；其余各块计算完整的状态映射，最后按顺序组合
+    ScanResult result;
+    vector<StateMap> maps(chunks - 1);
+    ParallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            size_t begin = text.size() * c / chunks;
+            string_view piece = text.substr(begin, text.size() * (c + 1) / chunks - begin);
+            if (c == 0) {
+                result = ScanFrom(table, table.start, piece);
+            } else {
+                maps[c - 1] = ComputeStateMap(table, piece, true);
+            }
+        }
+    });
+    for (const auto& map : maps) {
+        result.matches += map.MatchesFrom(result.row);
+        result.row = map.Apply(result.row);
+    }
+    return result;
+}
@@ -0,0 +1,215 @@
+#include "table_export.h"
+#include "buffered_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+vector<bool> AcceptingFlags(const Automaton& dfa)
+{
+    vector<bool> accepting(dfa.GetNumStates(), false);
+    for (int s : dfa.GetAcceptingStates()) {
+        accepting[static_cast<size_t>(s)] = true;
+    }
+    return accepting;
+}
+
+// Symbols of each alphabet column, in character order
+vector<string> ColumnSymbols(const Automaton& dfa)
+{
+    vector<string> symbols(dfa.GetNumColumns());
+    for (size_t col = 0; col < symbols.size(); col++) {
+        symbols[col] = dfa.GetByteClasses().Symbols(col);
+    }
+    return symbols;
+}
+
+// Writes `c` so it can appear inside a double-quoted DOT or CSV string
+void WriteQuotedChar(BufferedWriter& w, char c, bool csv)
+{
+    unsigned char byte = static_cast<unsigned char>(c);
+    if (c == '"') {
+        w.Write(csv ? "\"\"" : "\\\"");
+    } else if (c == '\\' && !csv) {
+        w.Write("\\\\");
+    } else if (byte < 0x20 || byte >= 0x7f) {
+        static const char hex[] = "0123456789abcdef";
+        w.Write("\\x");
+        w.Put(hex[byte >> 4]);
+        w.Put(hex[byte & 0xf]);
+    } else {
+        w.Put(c);
+    }
+}
+
+void WriteText(const Automaton& dfa, BufferedWriter& w)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    vector<bool> accepting = AcceptingFlags(dfa);
+
+    w.Write("Transition Table:\n----------------\n");
+
+    // 打印列标题（输入符号），多个字符共用一列时打印字符类
+    w.Write("State |");
+    for (size_t col = 0; col < dfa.GetNumColumns(); col++) {
+        string symbols = dfa.GetByteClasses().Symbols(col);
+        if (symbols.size() == 1) {
+            w.Write(" '");
+            w.Put(symbols[0]);
+            w.Write("' |");
+        } else {
+            w.Put(' ');
+            w.Write(dfa.GetByteClasses().Describe(col));
+            w.Write(" |");
+        }
+    }
+    w.Put('\n');
+
+    // 打印分隔线
+    w.Write("------|");
+    for (size_t i = 0; i < dfa.GetNumColumns(); i++) {
+        w.Write("-----|");
+    }
+    w.Put('\n');
+
+    // 打印每个状态的转移
+    for (size_t i = 0; i < M.size(); i++) {
+        w.Write("  ");
+        w.WriteInt(i);
+        w.Write("   |");
+        for (int target : M[i]) {
+            w.Write("  ");
+            w.WriteInt(target);
+            w.Write("  |");
+        }
+        if (accepting[i]) {
+            w.Write(" (accepting)");
+        }
+        w.Put('\n');
+    }
+}
+
+void WriteDot(const Automaton& dfa, BufferedWriter& w)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    vector<bool> accepting = AcceptingFlags(dfa);
+    vector<string> symbols = ColumnSymbols(dfa);
+
+    w.Write("digraph automaton {\n  rankdir=LR;\n  start [shape=point];\n  start -> ");
+    w.WriteInt(dfa.GetInitialState());
+    w.Write(";\n");
+
+    for (size_t i = 0; i < M.size(); i++) {
+        w.Write("  ");
+        w.WriteInt(i);
+        w.Write(accepting[i] ? " [shape=doublecircle];\n" : " [shape=circle];\n");
+    }
+
+    // 同一对状态之间的多条边合并为一条，标签列出所有符号
+    vector<std::pair<int, size_t>> edges;  // (target, column)
+    for (size_t i = 0; i < M.size(); i++) {
+        edges.clear();
+        for (size_t col = 0; col < M[i].size(); col++) {
+            edges.emplace_back(M[i][col], col);
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t k = 0; k < edges.size();) {
+            int target = edges[k].first;
+            w.Write("  ");
+            w.WriteInt(i);
+            w.Write(" -> ");
+            w.WriteInt(target);
+            w.Write(" [label=\"");
+            bool separator = false;
+            for (; k < edges.size() && edges[k].first == target; k++) {
+                for (char c : symbols[edges[k].second]) {
+                    if (separator) {
+                        w.Put(',');
+                    }
+                    WriteQuotedChar(w, c, false);
+                    separator = true;
+                }
+            }
+            w.Write("\"];\n");
+        }
+    }
+    w.Write("}\n");
+}
+
+void WriteCsv(const Automaton& dfa, BufferedWriter& w)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    vector<bool> accepting = AcceptingFlags(dfa);
+
+    w.Write("state");
+    for (const string& column : ColumnSymbols(dfa)) {
+        w.Write(",\"");
+        for (char c : column) {
+            WriteQuotedChar(w, c, true);
+        }
+        w.Put('"');
+    }
+    w.Write(",accepting\n");
+
+    for (size_t i = 0; i < M.size(); i++) {
+        w.WriteInt(i);
+        for (int target : M[i]) {
+            w.Put(',');
+            w.WriteInt(target);
+        }
+        w.Write(accepting[i] ? ",1\n" : ",0\n");
+    }
+}
+
+void Export(const Automaton& dfa, BufferedWriter& w, TableFormat format)
+{
+    switch (format) {
+    case TableFormat::Text:
+        WriteText(dfa, w);
+        break;
+    case TableFormat::Dot:
+        WriteDot(dfa, w);
+        break;
+    case TableFormat::Csv:
+        WriteCsv(dfa, w);
+        break;
+    }
+    w.Flush();
+}
+
+// 仅在导出途中抛出异常时关闭文件；正常结束时显式关闭以检查错误
+struct FileCloser
+{
+    void operator()(std::FILE* f) const { std::fclose(f); }
+};
+
+} // namespace
+
+void ExportTable(const Automaton& dfa, std::ostream& out, TableFormat format)
+{
+    BufferedWriter w(out);
+    Export(dfa, w, format);
+    out.flush();
+}
+
+void ExportTableFile(const Automaton& dfa, const string& path, TableFormat format)
+{
+    std::unique_ptr<std::FILE, FileCloser> f(std::fopen(path.c_str(), "wb"));
+    if (!f) {
+        throw std::runtime_error("Cannot open output file: " + path);
+    }
+    {
+        BufferedWriter w(f.get());
+        Export(dfa, w, format);
+    }
+    // stdio 的最后一次刷新发生在 fclose 中，磁盘已满等错误只能从这里得知
+    if (std::fclose(f.release()) != 0) {
+        throw std::runtime_error("Cannot finish writing output file: " + path);
+    }
+}
@@ -0,0 +1,209 @@
+#include "table_memory.h"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+std::size_t RoundToHugePages(std::size_t bytes)
+{
+    return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+}
+
+bool UsesMapping(std::size_t bytes, HugePages huge_pages)
+{
+    return huge_pages != HugePages::None && bytes >= kHugePageSize;
+}
+
+// 多映射一个大页再裁掉首尾，得到按大页对齐的区域，透明大页才能覆盖整个表
+void* MapAligned(std::size_t length)
+{
+    std::size_t padded = length + kHugePageSize;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(raw);
+    std::uintptr_t aligned = (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    std::size_t head = aligned - begin;
+    std::size_t tail = padded - head - length;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + length), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+std::string ReadLine(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+} // namespace
+
+void* AllocateTableMemory(std::size_t bytes, HugePages huge_pages)
+{
+    if (!UsesMapping(bytes, huge_pages)) {
+        return ::operator new(bytes);
+    }
+    std::size_t length = RoundToHugePages(bytes);
+    if (huge_pages == HugePages::Explicit) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+        // 大页池未预留或已用完时退回透明大页
+    }
+    void* p = MapAligned(length);
+    madvise(p, length, MADV_HUGEPAGE);  // 内核不支持时只是没有效果
+    return p;
+}
+
+void FreeTableMemory(void* p, std::size_t bytes, HugePages huge_pages)
+{
+    if (!UsesMapping(bytes, huge_pages)) {
+        ::operator delete(p);
+        return;
+    }
+    // 两种映射的长度都按大页取整，munmap可以统一处理
+    munmap(p, RoundToHugePages(bytes));
+}
+
+vector<int> ParseCpuList(const string& list)
+{
+    vector<int> cpus;
+    size_t pos = 0;
+    auto number = [&]() {
+        size_t used = 0;
+        int value = 0;
+        try {
+            value = std::stoi(list.substr(pos), &used);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid CPU list: '" + list + "'");
+        }
+        if (value < 0) {
+            throw std::invalid_argument("Invalid CPU list: '" + list + "'");
+        }
+        pos += used;
+        return value;
+    };
+    while (pos < list.size() && list[pos] != '\n') {
+        int first = number();
+        int last = first;
+        if (pos < list.size() && list[pos] == '-') {
+            pos++;
+            last = number();
+            if (last < first) {
+                throw std::invalid_argument("Invalid CPU list: '" + list + "'");
+            }
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+        if (pos < list.size() && list[pos] == ',') {
+            pos++;
+        }
+    }
+    return cpus;
+}
+
+NumaTopology DetectNumaTopology()
+{
+    NumaTopology topology;
+    const string root = "/sys/devices/system/node/";
+    vector<int> nodes;
+    try {
+        nodes = ParseCpuList(ReadLine(root + "online"));
+    } catch (const std::invalid_argument&) {
+        nodes.clear();
+    }
+    for (int node : nodes) {
+        vector<int> cpus;
+        try {
+            cpus = ParseCpuList(ReadLine(root + "node" + std::to_string(node) + "/cpulist"));
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        // 只有内存没有CPU的节点上不会有线程运行，不需要副本
+        if (!cpus.empty()) {
+            topology.cpus.push_back(std::move(cpus));
+        }
+    }
+
+    if (topology.cpus.empty()) {
+        vector<int> all;
+        unsigned count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < count; cpu++) {
+            all.push_back(static_cast<int>(cpu));
+        }
+        topology.cpus.push_back(std::move(all));
+    }
+
+    for (size_t node = 0; node < topology.cpus.size(); node++) {
+        for (int cpu : topology.cpus[node]) {
+            if (static_cast<size_t>(cpu) >= topology.node_of_cpu.size()) {
+                topology.node_of_cpu.resize(static_cast<size_t>(cpu) + 1, -1);
+            }
+            topology.node_of_cpu[static_cast<size_t>(cpu)] = static_cast<int>(node);
+        }
+    }
+    return topology;
+}
+
+std::size_t NumaTopology::CurrentNode() const
+{
+    int cpu = sched_getcpu();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= node_of_cpu.size() || node_of_cpu[static_cast<size_t>(cpu)] < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(node_of_cpu[static_cast<size_t>(cpu)]);
+}
+
+void RunOnEachNode(const NumaTopology& topology, const std::function<void(std::size_t node)>& body)
+{
+    vector<std::exception_ptr> errors(topology.NumNodes());
+    vector<std::thread> threads;
+    threads.reserve(topology.NumNodes());
+    for (size_t node = 0; node < topology.NumNodes(); node++) {
+        threads.emplace_back([&, node]() {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : topology.cpus[node]) {
+                if (cpu < CPU_SETSIZE) {
+                    CPU_SET(static_cast<size_t>(cpu), &set);
+                }
+            }
+            // 绑定失败（如CPU不在允许集合中）时仍然执行，只是放置不再有保证
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            try {
+                body(node);
+            } catch (...) {
+                errors[node] = std::current_exception();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
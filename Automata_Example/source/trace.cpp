@@ -0,0 +1,160 @@
+#include "trace.h"
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+// Walks the compiled table one symbol at a time, calling visit(state) for every state on the path
+template <typename Visit>
+void WalkPath(const Automaton& dfa, const string& word, Visit visit)
+{
+    const DfaTable& table = dfa.GetTable();
+    DfaTable::StateId row = table.start;
+    visit(table.StateOf(row));
+    for (char c : word) {
+        row = table.Step(row, static_cast<unsigned char>(c));
+        if (row == DfaTable::kInvalidRow) {
+            throw std::invalid_argument("Invalid input symbol: '" + string(1, c) + "'");
+        }
+        visit(table.StateOf(row));
+    }
+}
+
+// 仅在出错提前返回时关闭文件；写文件正常结束时显式关闭以检查错误
+struct FileCloser
+{
+    void operator()(std::FILE* f) const { std::fclose(f); }
+};
+
+} // namespace
+
+size_t TraceStates(const Automaton& dfa, const string& word, uint32_t* out, size_t capacity)
+{
+    size_t n = 0;
+    WalkPath(dfa, word, [&](uint32_t state) {
+        if (n < capacity) {
+            out[n] = state;
+        }
+        n++;
+    });
+    return n;
+}
+
+void TraceLog::Append(uint32_t state)
+{
+    // zigzag 编码让负的差值也只占很少的字节
+    int64_t delta = static_cast<int64_t>(state) - static_cast<int64_t>(last);
+    uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    while (zigzag >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(zigzag));
+    last = state;
+    count++;
+}
+
+vector<uint32_t> TraceLog::Decode() const
+{
+    vector<uint32_t> states;
+    states.reserve(count);
+    uint32_t current = 0;
+    size_t i = 0;
+    while (i < bytes.size()) {
+        uint64_t zigzag = 0;
+        int shift = 0;
+        while (true) {
+            if (i >= bytes.size() || shift > 63) {
+                throw std::invalid_argument("Trace log is truncated or corrupt");
+            }
+            uint8_t b = bytes[i++];
+            zigzag |= static_cast<uint64_t>(b & 0x7f) << shift;
+            shift += 7;
+            if ((b & 0x80) == 0) {
+                break;
+            }
+        }
+        int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        int64_t state = static_cast<int64_t>(current) + delta;
+        if (state < 0 || state > static_cast<int64_t>(UINT32_MAX)) {
+            throw std::invalid_argument("Trace log is truncated or corrupt");
+        }
+        current = static_cast<uint32_t>(state);
+        states.push_back(current);
+    }
+    return states;
+}
+
+TraceLog TraceLog::FromBytes(vector<uint8_t> data)
+{
+    TraceLog log;
+    log.bytes = std::move(data);
+    vector<uint32_t> states = log.Decode();
+    log.count = states.size();
+    log.last = states.empty() ? 0 : states.back();
+    return log;
+}
+
+void TraceLog::WriteFile(const string& path) const
+{
+    std::unique_ptr<std::FILE, FileCloser> f(std::fopen(path.c_str(), "wb"));
+    if (!f || std::fwrite(bytes.data(), 1, bytes.size(), f.get()) != bytes.size()) {
+        throw std::runtime_error("Cannot write trace file: " + path);
+    }
+    // 最后一次刷新发生在 fclose 中，磁盘已满等错误只能从这里得知
+    if (std::fclose(f.release()) != 0) {
+        throw std::runtime_error("Cannot finish writing trace file: " + path);
+    }
+}
+
+TraceLog TraceLog::ReadFile(const string& path)
+{
+    std::unique_ptr<std::FILE, FileCloser> f(std::fopen(path.c_str(), "rb"));
+    if (!f) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    vector<uint8_t> data;
+    uint8_t buffer[1 << 16];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f.get())) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    // fread 在出错和文件结束时都返回0，需要区分
+    if (std::ferror(f.get())) {
+        throw std::runtime_error("Cannot read trace file: " + path);
+    }
+    return FromBytes(std::move(data));
+}
+
+TraceLog RecordTrace(const Automaton& dfa, const string& word)
+{
+    TraceLog log;
+    WalkPath(dfa, word, [&](uint32_t state) { log.Append(state); });
+    return log;
+}
+
+TraceDiff ReplayTrace(const Automaton& dfa, const string& word, const TraceLog& recorded)
+{
+    vector<uint32_t> expected = recorded.Decode();
+    TraceDiff diff;
+    size_t i = 0;
+    WalkPath(dfa, word, [&](uint32_t state) {
+        if (diff.identical && (i >= expected.size() || expected[i] != state)) {
+            diff.identical = false;
+            diff.position = i;
+            diff.expected = i < expected.size() ? expected[i] : TraceDiff::kNoState;
+            diff.actual = state;
+        }
+        i++;
+    });
+    if (diff.identical && i < expected.size()) {
+        diff.identical = false;
+        diff.position = i;
+        diff.expected = expected[i];
+    }
+    return diff;
+}
@@ -0,0 +1,88 @@
+#include "transducer.h"
+#include <stdexcept>
+
+using std::vector;
+using std::map;
+using std::string;
+
+Transducer::Transducer(map<char, int> A, vector<vector<int>> M, vector<int> S_A,
+                       const vector<vector<Output>>& O, Validation validation)
+    : dfa(std::move(A), std::move(M), std::move(S_A), validation)
+{
+    const DfaTable& table = dfa.GetTable();
+    const size_t num_states = dfa.GetNumStates();
+    const size_t num_columns = dfa.GetNumColumns();
+    if (validation == Validation::Full) {
+        ValidateOutputs(O, num_states, num_columns);
+    }
+
+    // 按编译后的行顺序存放输出，与转移表一一对应
+    auto out = std::make_shared<vector<Output>>(table.next.size(), 0);
+    for (size_t s = 0; s < num_states; s++) {
+        Output* row = out->data() + table.row_of[s];
+        for (size_t col = 0; col < num_columns; col++) {
+            row[col] = O[s][col];
+        }
+    }
+    output = std::move(out);
+    state = table.start;
+}
+
+void Transducer::ValidateOutputs(const vector<vector<Output>>& O, size_t num_states, size_t alphabet_size)
+{
+    if (O.size() != num_states) {
+        throw std::invalid_argument("Output matrix must have one row per state");
+    }
+    for (const auto& row : O) {
+        if (row.size() != alphabet_size) {
+            throw std::invalid_argument("Each state must have an output for each alphabet symbol");
+        }
+    }
+}
+
+bool Transducer::Read(const string& word, Output* outputs, bool reset)
+{
+    const DfaTable& table = dfa.GetTable();
+    if (reset) {
+        state = table.start;
+    }
+
+    const DfaTable::StateId* next = table.next.data();
+    const Output* out = output->data();
+    const std::uint16_t* columns = table.column_of.data();
+    DfaTable::StateId r = state;
+    for (size_t i = 0; i < word.size(); i++) {
+        DfaTable::StateId cell = r + columns[static_cast<unsigned char>(word[i])];
+        DfaTable::StateId to = next[cell];
+        if (to == DfaTable::kInvalidRow) {
+            state = r;
+            throw std::invalid_argument("Invalid input symbol: '" + string(1, word[i]) +
+                "' at position " + std::to_string(i));
+        }
+        outputs[i] = out[cell];
+        r = to;
+    }
+    state = r;
+    return table.IsAccepting(state);
+}
+
+void Transducer::Reset()
+{
+    state = dfa.GetTable().start;
+}
+
+bool Transducer::IsInAcceptingState() const
+{
+    return dfa.GetTable().IsAccepting(state);
+}
+
+Transducer::Output Transducer::GetOutput(int s, char symbol) const
+{
+    int col = dfa.GetByteClasses().ColumnOf(symbol);
+    if (s < 0 || static_cast<size_t>(s) >= dfa.GetNumStates() || col < 0) {
+        throw std::invalid_argument("No transition from state " + std::to_string(s) +
+            " on symbol '" + string(1, symbol) + "'");
+    }
+    const DfaTable& table = dfa.GetTable();
+    return (*output)[table.row_of[static_cast<size_t>(s)] + static_cast<size_t>(col)];
+}
@@ -0,0 +1,330 @@
+#include "utf8_alphabet.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+constexpr char32_t kMaxCodePoint = 0x10FFFF;
+
+string CodePointName(char32_t cp)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "U+%04X", static_cast<unsigned>(cp));
+    return buffer;
+}
+
+struct ByteRange
+{
+    unsigned char lo;
+    unsigned char hi;
+};
+
+using ByteSequence = vector<ByteRange>;
+
+// Splits [lo, hi] into sequences of byte ranges whose cross products are
+// exactly the UTF-8 encodings of the range. Whenever a sequence has a range
+// wider than one byte, every later range in it is the full 80-BF.
+void SplitRange(char32_t lo, char32_t hi, vector<ByteSequence>& out)
+{
+    if (lo > hi) {
+        return;
+    }
+    // 代理项不是合法的标量值，直接跳过
+    if (lo <= 0xDFFF && hi >= 0xD800) {
+        if (lo < 0xD800) {
+            SplitRange(lo, 0xD7FF, out);
+        }
+        if (hi > 0xDFFF) {
+            SplitRange(0xE000, hi, out);
+        }
+        return;
+    }
+    // 按编码长度切分
+    for (char32_t max : {char32_t{0x7F}, char32_t{0x7FF}, char32_t{0xFFFF}}) {
+        if (lo <= max && hi > max) {
+            SplitRange(lo, max, out);
+            SplitRange(max + 1, hi, out);
+            return;
+        }
+    }
+    if (hi <= 0x7F) {
+        out.push_back({{static_cast<unsigned char>(lo), static_cast<unsigned char>(hi)}});
+        return;
+    }
+    // 对齐到续字节边界，使每一位置的字节范围相互独立
+    for (unsigned i = 1; i < 4; i++) {
+        char32_t m = (char32_t{1} << (6 * i)) - 1;
+        if ((lo & ~m) != (hi & ~m)) {
+            if ((lo & m) != 0) {
+                SplitRange(lo, lo | m, out);
+                SplitRange((lo | m) + 1, hi, out);
+                return;
+            }
+            if ((hi & m) != m) {
+                SplitRange(lo, (hi & ~m) - 1, out);
+                SplitRange(hi & ~m, hi, out);
+                return;
+            }
+        }
+    }
+    string a = EncodeUtf8(lo);
+    string b = EncodeUtf8(hi);
+    ByteSequence sequence;
+    for (size_t i = 0; i < a.size(); i++) {
+        sequence.push_back({static_cast<unsigned char>(a[i]), static_cast<unsigned char>(b[i])});
+    }
+    out.push_back(sequence);
+}
+
+void ValidateUtf8Definition(const vector<Utf8Symbol>& alphabet, const vector<vector<int>>& M,
+                            const vector<int>& S_A)
+{
+    if (M.empty()) {
+        throw std::invalid_argument("Transition matrix cannot be empty");
+    }
+    const size_t num_columns = M[0].size();
+    for (size_t i = 0; i < M.size(); i++) {
+        if (M[i].size() != num_columns) {
+            throw std::invalid_argument("Each state must have a transition for each alphabet column");
+        }
+        for (int target : M[i]) {
+            if (target < 0 || static_cast<size_t>(target) >= M.size()) {
+                throw std::invalid_argument("Transition to invalid state: " +
+                    std::to_string(target) + " from state " + std::to_string(i));
+            }
+        }
+    }
+    for (int s : S_A) {
+        if (s < 0 || static_cast<size_t>(s) >= M.size()) {
+            throw std::invalid_argument("Accepting states must be valid state indices.");
+        }
+    }
+
+    vector<Utf8Symbol> sorted = alphabet;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Utf8Symbol& a, const Utf8Symbol& b) { return a.first < b.first; });
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const Utf8Symbol& symbol = sorted[i];
+        if (symbol.first > symbol.last || symbol.last > kMaxCodePoint) {
+            throw std::invalid_argument("Invalid code point range " + CodePointName(symbol.first) +
+                " .. " + CodePointName(symbol.last));
+        }
+        if (symbol.column < 0 || static_cast<size_t>(symbol.column) >= num_columns) {
+            throw std::invalid_argument("Alphabet column " + std::to_string(symbol.column) +
+                " has no transitions");
+        }
+        if (i > 0 && sorted[i - 1].last >= symbol.first) {
+            throw std::invalid_argument("Code point ranges of the alphabet overlap");
+        }
+    }
+}
+
+// Byte-level states under construction; -1 is a transition not set yet
+class ByteDfaBuilder
+{
+public:
+    explicit ByteDfaBuilder(size_t num_states)
+    {
+        for (size_t i = 0; i < num_states; i++) {
+            AddState();
+        }
+    }
+
+    int AddState()
+    {
+        next.emplace_back();
+        next.back().fill(-1);
+        return static_cast<int>(next.size()) - 1;
+    }
+
+    void Insert(int state, const ByteSequence& sequence, size_t depth, int target)
+    {
+        const ByteRange range = sequence[depth];
+        const size_t remaining = sequence.size() - 1 - depth;
+        if (remaining == 0) {
+            Set(state, range, target);
+            return;
+        }
+        bool free_suffix = std::all_of(sequence.begin() + static_cast<long>(depth) + 1, sequence.end(),
+                                       [](ByteRange r) { return r.lo == 0x80 && r.hi == 0xBF; });
+        if (free_suffix) {
+            Set(state, range, Continuations(remaining, target));
+            return;
+        }
+        // Otherwise the range is a single byte (see SplitRange)
+        if (next[static_cast<size_t>(state)][range.lo] < 0) {
+            int created = AddState();
+            next[static_cast<size_t>(state)][range.lo] = created;
+        }
+        Insert(next[static_cast<size_t>(state)][range.lo], sequence, depth + 1, target);
+    }
+
+    // Merges intermediate states (those from `first` on) with identical rows,
+    // repeating until parents of merged states stop becoming identical, then
+    // drops the states nothing points to any more
+    void MergeDuplicates(int first)
+    {
+        const size_t begin = static_cast<size_t>(first);
+        vector<int> replace(next.size());
+        for (size_t s = 0; s < next.size(); s++) {
+            replace[s] = static_cast<int>(s);
+        }
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            map<std::array<int, 256>, int> canonical;
+            for (size_t s = begin; s < next.size(); s++) {
+                if (replace[s] != static_cast<int>(s)) {
+                    continue;
+                }
+                auto inserted = canonical.emplace(next[s], static_cast<int>(s));
+                if (!inserted.second) {
+                    replace[s] = inserted.first->second;
+                    changed = true;
+                }
+            }
+            for (auto& row : next) {
+                for (int& target : row) {
+                    if (target >= 0) {
+                        target = replace[static_cast<size_t>(target)];
+                    }
+                }
+            }
+        }
+
+        vector<int> renumber(next.size(), -1);
+        vector<std::array<int, 256>> kept;
+        for (size_t s = 0; s < next.size(); s++) {
+            if (s < begin || replace[s] == static_cast<int>(s)) {
+                renumber[s] = static_cast<int>(kept.size());
+                kept.push_back(next[s]);
+            }
+        }
+        for (auto& row : kept) {
+            for (int& target : row) {
+                if (target >= 0) {
+                    target = renumber[static_cast<size_t>(target)];
+                }
+            }
+        }
+        next = std::move(kept);
+    }
+
+    vector<std::array<int, 256>> next;
+
+private:
+    map<std::pair<size_t, int>, int> continuations;
+
+    void Set(int state, ByteRange range, int target)
+    {
+        for (unsigned b = range.lo; b <= range.hi; b++) {
+            next[static_cast<size_t>(state)][b] = target;
+        }
+    }
+
+    // State that reads `count` continuation bytes and then is in `target`
+    int Continuations(size_t count, int target)
+    {
+        auto it = continuations.find({count, target});
+        if (it != continuations.end()) {
+            return it->second;
+        }
+        int after = count == 1 ? target : Continuations(count - 1, target);
+        int state = AddState();
+        Set(state, {0x80, 0xBF}, after);
+        continuations[{count, target}] = state;
+        return state;
+    }
+};
+
+} // namespace
+
+string EncodeUtf8(char32_t cp)
+{
+    if (cp > kMaxCodePoint || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        throw std::invalid_argument("Not a Unicode scalar value: " + CodePointName(cp));
+    }
+    string out;
+    if (cp <= 0x7F) {
+        out += static_cast<char>(cp);
+    } else if (cp <= 0x7FF) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp <= 0xFFFF) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+Automaton CompileUtf8Automaton(const vector<Utf8Symbol>& alphabet, const vector<vector<int>>& M,
+                               const vector<int>& S_A)
+{
+    ValidateUtf8Definition(alphabet, M, S_A);
+
+    vector<vector<ByteSequence>> sequences(alphabet.size());
+    for (size_t i = 0; i < alphabet.size(); i++) {
+        SplitRange(alphabet[i].first, alphabet[i].last, sequences[i]);
+    }
+
+    // 原状态保持编号，之后依次是死状态和多字节序列的中间状态
+    ByteDfaBuilder builder(M.size());
+    const int dead = builder.AddState();
+    for (size_t q = 0; q < M.size(); q++) {
+        for (size_t i = 0; i < alphabet.size(); i++) {
+            int target = M[q][static_cast<size_t>(alphabet[i].column)];
+            for (const auto& sequence : sequences[i]) {
+                builder.Insert(static_cast<int>(q), sequence, 0, target);
+            }
+        }
+    }
+
+    builder.MergeDuplicates(dead + 1);
+
+    // Bytes that start or continue some encoding, with identical targets in
+    // every state, share one column
+    std::array<uint16_t, 256> column_of;
+    column_of.fill(ByteClasses::kNoColumn);
+    std::map<vector<int>, uint16_t> columns;
+    vector<unsigned> used;  // one byte of each column
+    vector<int> targets(builder.next.size());
+    for (unsigned b = 0; b < 256; b++) {
+        bool any = false;
+        for (size_t s = 0; s < builder.next.size(); s++) {
+            int target = builder.next[s][b];
+            any = any || target >= 0;
+            targets[s] = target >= 0 ? target : dead;
+        }
+        if (!any) {
+            continue;
+        }
+        auto [it, inserted] = columns.emplace(targets, static_cast<uint16_t>(used.size()));
+        if (inserted) {
+            used.push_back(b);
+        }
+        column_of[b] = it->second;
+    }
+
+    vector<vector<int>> byte_matrix(builder.next.size(), vector<int>(used.size()));
+    for (size_t s = 0; s < builder.next.size(); s++) {
+        for (size_t col = 0; col < used.size(); col++) {
+            int target = builder.next[s][used[col]];
+            byte_matrix[s][col] = target >= 0 ? target : dead;
+        }
+    }
+    return Automaton(ByteClasses::FromTable(column_of, used.size()), std::move(byte_matrix), S_A,
+                     Validation::Trusted);
+}
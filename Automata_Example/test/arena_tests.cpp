@@ -0,0 +1,163 @@
+#include <catch2/catch_test_macros.hpp>
+#include "automaton.h"
+#include "differential.h"
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::vector;
+using std::string;
+
+// Counts every heap allocation of this test binary
+namespace {
+std::atomic<size_t> heap_allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    heap_allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+// An automaton in the form the flat constructor takes
+struct FlatDefinition
+{
+    ByteClasses alphabet;
+    size_t num_states = 0;
+    vector<int> transitions;
+    vector<int> accepting;
+};
+
+FlatDefinition Flatten(const Automaton& dfa)
+{
+    FlatDefinition flat;
+    flat.alphabet = dfa.GetByteClasses();
+    flat.num_states = dfa.GetNumStates();
+    for (const auto& row : dfa.GetTransitionMatrix()) {
+        flat.transitions.insert(flat.transitions.end(), row.begin(), row.end());
+    }
+    flat.accepting = dfa.GetAcceptingStates();
+    return flat;
+}
+
+} // namespace
+
+TEST_CASE("Automata built in an arena", "[arena]") {
+    std::mt19937_64 rng(50);
+
+    SECTION("A batch fits its estimate and allocates nothing on the heap") {
+        vector<Automaton> reference;
+        vector<FlatDefinition> flat;
+        size_t bytes = 0;
+        for (int i = 0; i < 300; i++) {
+            reference.push_back(GenerateAutomaton(rng, 1 + rng() % 50, 1 + rng() % 8));
+            flat.push_back(Flatten(reference.back()));
+            bytes += Automaton::ArenaBytes(flat.back().num_states, flat.back().alphabet.NumColumns());
+        }
+        vector<char> buffer(bytes);
+        // Running past the estimate would throw std::bad_alloc
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+        TablePlacement placement;
+        placement.arena = &arena;
+
+        std::pmr::vector<Automaton> batch(&arena);
+        batch.reserve(flat.size());
+        const size_t before = heap_allocations;
+        for (const auto& f : flat) {
+            batch.emplace_back(f.alphabet, f.num_states, f.transitions.data(), f.accepting.data(), f.accepting.size(),
+                               Validation::Full, placement);
+        }
+        REQUIRE(heap_allocations == before);
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            vector<string> words = GenerateWords(rng, reference[i], 20, 30);
+            vector<std::string_view> views(words.begin(), words.end());
+            vector<ReadResult> expected;
+            vector<ReadResult> actual;
+            ReferenceRead(reference[i], views, expected);
+            ReferenceRead(batch[i], views, actual);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("The estimate holds for larger automata") {
+        for (size_t num_states : {size_t{1}, size_t{1000}, size_t{20000}}) {
+            for (size_t num_columns : {size_t{1}, size_t{26}, size_t{128}}) {
+                Automaton reference = GenerateAutomaton(rng, num_states, num_columns);
+                FlatDefinition f = Flatten(reference);
+                vector<char> buffer(Automaton::ArenaBytes(num_states, num_columns));
+                std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                                          std::pmr::null_memory_resource());
+                TablePlacement placement;
+                placement.arena = &arena;
+                Automaton dfa(f.alphabet, f.num_states, f.transitions.data(), f.accepting.data(),
+                              f.accepting.size(), Validation::Full, placement);
+
+                vector<string> words = GenerateWords(rng, reference, 200, 300);
+                vector<std::string_view> views(words.begin(), words.end());
+                vector<ReadResult> expected;
+                vector<ReadResult> actual;
+                ReferenceRead(reference, views, expected);
+                ReferenceRead(dfa, views, actual);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+
+    SECTION("The nested definition is rebuilt on demand") {
+        std::map<char, int> alphabet{{'a', 0}, {'b', 1}};
+        vector<vector<int>> M{{1, 2}, {1, 0}, {2, 2}};
+        std::pmr::monotonic_buffer_resource arena;
+        TablePlacement placement;
+        placement.arena = &arena;
+        Automaton dfa(alphabet, M, {2, 0}, Validation::Full, placement);
+
+        REQUIRE(dfa.GetNumStates() == 3);
+        REQUIRE(dfa.GetTransitionMatrix() == M);
+        REQUIRE(dfa.GetAcceptingStates() == vector<int>{0, 2});
+        REQUIRE(dfa.GetAlphabet() == alphabet);
+        REQUIRE(dfa.Read("ab"));
+        REQUIRE_FALSE(dfa.Read("a"));
+        REQUIRE(dfa.IsAcceptingSink(2));
+
+        Automaton copy = dfa;
+        REQUIRE(&copy.GetTransitionMatrix() == &dfa.GetTransitionMatrix());
+    }
+
+    SECTION("Flat input is validated like the nested form") {
+        ByteClasses ab = ByteClasses::FromMap({{'a', 0}, {'b', 1}});
+        vector<int> transitions{0, 1, 1, 2};
+        vector<int> accepting{1};
+        REQUIRE_THROWS_AS(Automaton(ab, 0, transitions.data(), accepting.data(), 1), std::invalid_argument);
+        REQUIRE_THROWS_AS(Automaton(ab, 2, transitions.data(), accepting.data(), 1), std::invalid_argument);
+        transitions = {0, 1, 0, 1};
+        accepting[0] = 2;
+        REQUIRE_THROWS_AS(Automaton(ab, 2, transitions.data(), accepting.data(), 1), std::invalid_argument);
+        accepting[0] = 1;
+        Automaton dfa(ab, 2, transitions.data(), accepting.data(), 1);
+        REQUIRE(dfa.Read("b"));
+        REQUIRE_FALSE(dfa.Read("ba"));
+    }
+}
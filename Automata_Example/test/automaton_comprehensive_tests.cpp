@@ -3,6 +3,8 @@
 #include "automaton.h"
 #include <vector>
 #include <map>
+#include <iostream>
+#include <sstream>
 #include <stdexcept>
 
 using std::vector;
@@ -55,6 +57,16 @@ public:
         vector<int> accepting_states = {0};
         return Automaton(alphabet, transitions, accepting_states);
     }
+
+    // What PrintCurrentState writes, without the trailing newline
+    string printedState(const Automaton& dfa) {
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        dfa.PrintCurrentState();
+        std::cout.rdbuf(previous);
+        string text = out.str();
+        return text.substr(0, text.size() - 1);
+    }
 };
 
 TEST_CASE_METHOD(AutomatonFixture, "Basic DFA functionality", "[automaton][basic]") {
@@ -364,4 +376,148 @@ TEST_CASE("Edge cases", "[automaton][edge]") {
         REQUIRE(large_alphabet_dfa.Read("z"));
         REQUIRE(large_alphabet_dfa.Read("abcdefghijklmnopqrstuvwxyz"));
     }
+
+    SECTION("Large alphabet from a byte class") {
+        // All 26 letters share one column, so each row has a single entry;
+        // the automaton accepts words of even length
+        Automaton letters(ByteClasses::Parse({"[a-z]"}), {{1}, {0}}, {0});
+        REQUIRE(letters.GetNumColumns() == 1);
+        REQUIRE(letters.GetByteClasses().NumSymbols() == 26);
+        REQUIRE(letters.Read("abcdefghijklmnopqrstuvwxyz"));
+        REQUIRE_FALSE(letters.Read("xyz"));
+        REQUIRE_THROWS_AS(letters.Read("A"), std::invalid_argument);
+    }
+}
+
+TEST_CASE_METHOD(AutomatonFixture, "Early exit on absorbing states", "[automaton][absorbing]") {
+    SECTION("Dead state stops reading") {
+        auto dfa = createEmptyStringOnlyAutomaton();
+        REQUIRE(dfa.IsDeadState(2));
+        REQUIRE_FALSE(dfa.IsDeadState(0));
+        REQUIRE_FALSE(dfa.IsAcceptingSink(0));
+
+        // Once the sink is entered the remaining symbols are not inspected
+        REQUIRE_FALSE(dfa.Read("ab"));
+        REQUIRE_FALSE(dfa.Read("a?"));
+    }
+
+    SECTION("Accepting sink stops reading") {
+        auto dfa = createAlwaysAcceptingAutomaton();
+        REQUIRE(dfa.IsAcceptingSink(0));
+        REQUIRE(dfa.Read("ab?"));
+    }
+
+    SECTION("Trap state of a non-trivial DFA") {
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+        vector<vector<int>> transitions = {{1, 0}, {1, 2}, {2, 2}};
+        Automaton no_ab_dfa(alphabet, transitions, {0, 1});
+        REQUIRE(no_ab_dfa.IsDeadState(2));
+        REQUIRE_FALSE(no_ab_dfa.IsDeadState(1));
+        REQUIRE_FALSE(no_ab_dfa.IsAcceptingSink(0));
+
+        REQUIRE_FALSE(no_ab_dfa.Read("abaaaa"));
+        // Symbols before the trap state are still validated
+        REQUIRE_THROWS_AS(no_ab_dfa.Read("a?b"), std::invalid_argument);
+    }
+
+    SECTION("States that only cycle through accepting states") {
+        // 1 and 2 can never reject again, but they are not sinks: Read must keep
+        // walking so the current state stays exact
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+        vector<vector<int>> transitions = {{1, 0}, {2, 2}, {1, 1}};
+        Automaton dfa(alphabet, transitions, {1, 2});
+        REQUIRE_FALSE(dfa.IsAcceptingSink(0));
+        REQUIRE_FALSE(dfa.IsAcceptingSink(1));
+        REQUIRE_FALSE(dfa.IsAcceptingSink(2));
+        REQUIRE(dfa.Read("ba"));
+        REQUIRE_FALSE(dfa.Read("bbb"));
+
+        REQUIRE(dfa.Read("aa"));
+        REQUIRE(printedState(dfa) == "Current state: 2 (accepting)");
+        REQUIRE(dfa.Read("aab"));
+        REQUIRE(printedState(dfa) == "Current state: 1 (accepting)");
+        REQUIRE_THROWS_AS(dfa.Read("a#"), std::invalid_argument);
+    }
+
+    SECTION("Stopping at a sink leaves the exact state") {
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+        vector<vector<int>> transitions = {{1, 2}, {1, 1}, {0, 0}};
+        Automaton dfa(alphabet, transitions, {1});
+        REQUIRE(dfa.IsAcceptingSink(1));
+        REQUIRE_FALSE(dfa.IsDeadState(2));
+        REQUIRE(dfa.Read("aba"));
+        REQUIRE(printedState(dfa) == "Current state: 1 (accepting)");
+        REQUIRE_FALSE(dfa.Read("bab"));
+        REQUIRE_FALSE(dfa.Read("b"));
+        REQUIRE(printedState(dfa) == "Current state: 2");
+        // Symbols after a sink are not looked at, also ones outside the alphabet
+        REQUIRE(dfa.Read("a#"));
+        REQUIRE_THROWS_AS(dfa.Read("b#"), std::invalid_argument);
+    }
+}
+
+TEST_CASE_METHOD(AutomatonFixture, "Copies share the compiled table", "[automaton][copy]") {
+    auto original = createOddNumberOfAsAutomaton();
+    Automaton copy = original;
+
+    // Only the current state is duplicated
+    REQUIRE(&copy.GetTable() == &original.GetTable());
+    REQUIRE(&copy.GetTransitionMatrix() == &original.GetTransitionMatrix());
+
+    // Each copy keeps its own cursor
+    original.Read("a");
+    copy.Read("aa");
+    REQUIRE(original.IsInAcceptingState());
+    REQUIRE_FALSE(copy.IsInAcceptingState());
+    original.Read("a", false);
+    REQUIRE_FALSE(original.IsInAcceptingState());
+    REQUIRE_FALSE(copy.IsInAcceptingState());
+
+    Automaton moved = std::move(copy);
+    REQUIRE(&moved.GetTable() == &original.GetTable());
+    REQUIRE(moved.Read("bab"));
+}
+
+TEST_CASE("Byte class parsing", "[automaton][alphabet]") {
+    SECTION("Ranges, escapes and complements") {
+        ByteClasses classes = ByteClasses::Parse({
+            "[a-c_]", R"([\\\-\]])", "xyz", R"([\x00-\x1f])", R"([^a-z_\\\]\-\x00-\x1f])"});
+        REQUIRE(classes.NumColumns() == 5);
+        REQUIRE(classes.Symbols(0) == "_abc");
+        REQUIRE(classes.Symbols(1) == "-\\]");
+        REQUIRE(classes.Symbols(2) == "xyz");
+        REQUIRE(classes.ColumnOf('\n') == 3);
+        REQUIRE(classes.ColumnOf('d') == -1);
+        REQUIRE(classes.ColumnOf('A') == 4);
+        REQUIRE(classes.ColumnOf('\xff') == 4);
+        REQUIRE(classes.NumSymbols() == 256 - 20);  // all but d..w
+    }
+
+    SECTION("Describe gives a class that parses back to the same bytes") {
+        ByteClasses classes = ByteClasses::Parse({"[a-z0-9_]", R"([ \t\-^\[])", R"([^a-z0-9_ \t\-^\[])"});
+        vector<std::string> described;
+        for (size_t col = 0; col < classes.NumColumns(); col++) {
+            described.push_back(classes.Describe(col));
+        }
+        REQUIRE(described[0] == "[0-9_a-z]");
+        REQUIRE(ByteClasses::Parse(described).Table() == classes.Table());
+    }
+
+    SECTION("An unused column is written and parsed as []") {
+        ByteClasses classes = ByteClasses::FromMap({{'a', 0}, {'b', 0}});
+        REQUIRE(classes.NumColumns() == 2);
+        REQUIRE(classes.Describe(1) == "[]");
+        ByteClasses parsed = ByteClasses::Parse({classes.Describe(0), classes.Describe(1)});
+        REQUIRE(parsed.NumColumns() == 2);
+        REQUIRE(parsed.Table() == classes.Table());
+    }
+
+    SECTION("Invalid specifications") {
+        REQUIRE_THROWS_AS(ByteClasses::Parse({"[a-z]", "[x]"}), std::invalid_argument);
+        REQUIRE_THROWS_AS(ByteClasses::Parse({"[z-a]"}), std::invalid_argument);
+        REQUIRE_THROWS_AS(ByteClasses::Parse({"[a]", "[^\\x00-\\xff]"}), std::invalid_argument);
+        REQUIRE_THROWS_AS(ByteClasses::Parse({R"([\x4])"}), std::invalid_argument);
+        REQUIRE_THROWS_WITH(Automaton(ByteClasses::Parse({"[a-z]", "[0-9]"}), {{0}}, {0}),
+            "Each state must have a transition for each alphabet symbol");
+    }
 }
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include "counting.h"
+#include "test_automata.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+using std::vector;
+using std::map;
+
+namespace {
+
+const map<char, int> kAB = {{'a', 0}, {'b', 1}};
+const uint64_t kPrime = 1000000007;
+const uint64_t kMersenne61 = (uint64_t{1} << 61) - 1;
+
+} // namespace
+
+TEST_CASE("Exact counts", "[counting]") {
+    SECTION("Ends with b") {
+        REQUIRE(CountAcceptedWords(EndsWithB(), 0).ToString() == "0");
+        REQUIRE(CountAcceptedWords(EndsWithB(), 1).ToString() == "1");
+        REQUIRE(CountAcceptedWords(EndsWithB(), 10).ToString() == "512");
+        REQUIRE(CountAcceptedWords(EndsWithB(), 100).ToString() == "633825300114114700748351602688");
+    }
+
+    SECTION("Characters sharing a column count separately") {
+        // Column 2 is never used
+        Automaton all({{'a', 0}, {'b', 1}, {'c', 1}}, {{0, 0, 0}}, {0});
+        REQUIRE(CountAcceptedWords(all, 0).ToString() == "1");
+        REQUIRE(CountAcceptedWords(all, 50).ToString() == "717897987691852588770249");
+    }
+
+    SECTION("Unreachable accepting states do not count") {
+        Automaton dfa(kAB, {{0, 0}, {1, 1}}, {1});
+        REQUIRE(CountAcceptedWords(dfa, 5) == BigCount(0));
+        REQUIRE(CountAcceptedWordsMod(dfa, 1000, kPrime) == 0);
+    }
+}
+
+TEST_CASE("Modular counts", "[counting]") {
+    SECTION("Very long words use matrix powers") {
+        REQUIRE(CountAcceptedWordsMod(EndsWithB(), 1000000000000000000ULL, kPrime) == 359738130);
+        REQUIRE(CountAcceptedWordsMod(EndsWithB(), 1000000000000000000ULL, kMersenne61) == 1099511627776ULL);
+    }
+
+    SECTION("Agrees with the exact count on random automata") {
+        std::mt19937 rng(35);
+        for (int trial = 0; trial < 20; trial++) {
+            Automaton dfa = RandomAutomaton(rng, 2 + trial % 7, "ab");
+            for (size_t n : {size_t{0}, size_t{1}, size_t{7}, size_t{40}, size_t{300}}) {
+                BigCount exact = CountAcceptedWords(dfa, n);
+                REQUIRE(CountAcceptedWordsMod(dfa, n, kPrime) == exact.Mod(kPrime));
+                REQUIRE(CountAcceptedWordsMod(dfa, n, kMersenne61) == exact.Mod(kMersenne61));
+                REQUIRE(CountAcceptedWordsMod(dfa, n, 1) == 0);
+            }
+        }
+    }
+
+    SECTION("Zero modulus is rejected") {
+        REQUIRE_THROWS_AS(CountAcceptedWordsMod(EndsWithB(), 3, 0), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Uniform word sampling", "[counting]") {
+    std::mt19937_64 rng(36);
+
+    SECTION("Samples are accepted and have the requested length") {
+        std::mt19937 build(36);
+        for (int trial = 0; trial < 10; trial++) {
+            Automaton dfa = RandomAutomaton(build, 3 + trial, "ab");
+            WordSampler sampler(dfa, 20);
+            for (size_t length = 0; length <= 20; length++) {
+                REQUIRE(sampler.HasWords(length) == (CountAcceptedWords(dfa, length) != BigCount(0)));
+                std::string word;
+                if (sampler.Sample(length, rng, word)) {
+                    REQUIRE(word.size() == length);
+                    REQUIRE(dfa.Read(word));
+                } else {
+                    REQUIRE(word.empty());
+                }
+            }
+        }
+    }
+
+    SECTION("Every accepted word is about equally likely") {
+        // Ends with b, but characters c and d share the 'a' column
+        Automaton dfa({{'a', 0}, {'b', 1}, {'c', 0}, {'d', 0}},
+                      {{0, 1, 0, 0}, {0, 1, 0, 0}}, {1});
+        WordSampler sampler(dfa, 3);
+        map<std::string, int> seen;
+        const int draws = 16 * 4000;
+        for (int i = 0; i < draws; i++) {
+            std::string word;
+            REQUIRE(sampler.Sample(3, rng, word));
+            seen[word]++;
+        }
+        REQUIRE(seen.size() == 16);
+        for (const auto& pair : seen) {
+            REQUIRE(pair.first.back() == 'b');
+            REQUIRE(pair.second > 3400);
+            REQUIRE(pair.second < 4600);
+        }
+    }
+
+    SECTION("Long words do not overflow the counts") {
+        Automaton all({{'a', 0}, {'b', 1}, {'c', 2}}, {{0, 0, 0}}, {0});
+        WordSampler sampler(all, 2000);
+        std::string word;
+        REQUIRE(sampler.Sample(2000, rng, word));
+        REQUIRE(word.size() == 2000);
+        REQUIRE(word.find_first_not_of("abc") == std::string::npos);
+    }
+
+    SECTION("Corpus with a length distribution") {
+        WordSampler sampler(EndsWithB(), 10);
+        vector<double> weights = {1, 0, 1, 1};  // length 0 has no words
+        auto corpus = sampler.SampleCorpus(1000, weights, rng);
+        REQUIRE(corpus.Size() == 1000);
+        REQUIRE(corpus.offsets.back() == corpus.data.size());
+        size_t short_words = 0;
+        for (size_t i = 0; i < corpus.Size(); i++) {
+            auto word = corpus.Word(i);
+            REQUIRE((word.size() == 2 || word.size() == 3));
+            REQUIRE(word.back() == 'b');
+            short_words += word.size() == 2;
+        }
+        REQUIRE(short_words > 400);
+        REQUIRE(short_words < 600);
+
+        REQUIRE_THROWS_AS(sampler.SampleCorpus(1, {1, 0}, rng), std::invalid_argument);
+        REQUIRE_THROWS_AS(sampler.SampleCorpus(1, vector<double>(12, 1.0), rng), std::invalid_argument);
+    }
+
+    SECTION("Lengths beyond the precomputed range are rejected") {
+        WordSampler sampler(EndsWithB(), 4);
+        std::string word;
+        REQUIRE_FALSE(sampler.HasWords(5));
+        REQUIRE_THROWS_AS(sampler.Sample(5, rng, word), std::invalid_argument);
+    }
+}
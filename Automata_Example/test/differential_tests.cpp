@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+#include "differential.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::string;
+using std::string_view;
+
+namespace {
+
+vector<string_view> Views(const vector<string>& words)
+{
+    return vector<string_view>(words.begin(), words.end());
+}
+
+} // namespace
+
+TEST_CASE("Differential harness", "[differential]") {
+    SECTION("Engines have distinct names") {
+        std::set<string> names;
+        for (const auto& engine : ReadEngines()) {
+            REQUIRE_FALSE(engine.name.empty());
+            REQUIRE(names.insert(engine.name).second);
+        }
+        REQUIRE(names.size() >= 10);
+    }
+
+    SECTION("Reference maps the exception of Read to InvalidSymbol") {
+        std::map<char, int> alphabet{{'a', 0}, {'b', 1}};
+        Automaton dfa(alphabet, {{1, 0}, {1, 0}}, {1});
+        vector<ReadResult> results;
+        ReferenceRead(dfa, {"ba", "ab", "", "abc"}, results);
+        REQUIRE(results == vector<ReadResult>{ReadResult::Accepted, ReadResult::Rejected, ReadResult::Rejected,
+                                              ReadResult::InvalidSymbol});
+    }
+
+    SECTION("A wrong engine is reported") {
+        std::mt19937_64 rng(49);
+        Automaton dfa = GenerateAutomaton(rng, 8, 3);
+        vector<string> words = GenerateWords(rng, dfa, 50, 20);
+        vector<ReadEngine> engines = {
+            {"always rejects", [](const Automaton&, const vector<string_view>& words, vector<ReadResult>& results) {
+                 results.assign(words.size(), ReadResult::Rejected);
+             }},
+            {"throws", [](const Automaton&, const vector<string_view>&, vector<ReadResult>&) {
+                 throw std::runtime_error("boom");
+             }},
+        };
+        vector<ReadResult> expected;
+        ReferenceRead(dfa, Views(words), expected);
+        REQUIRE(std::count(expected.begin(), expected.end(), ReadResult::Rejected) < 50);
+
+        auto found = CompareEngines(dfa, Views(words), engines);
+        REQUIRE(found.size() == 2);
+        REQUIRE(found[0].engine == "always rejects");
+        REQUIRE(expected[found[0].word] != ReadResult::Rejected);
+        REQUIRE(found[0].Describe(Views(words)).find("always rejects returned Rejected") == 0);
+        REQUIRE(found[1].error == "boom");
+    }
+
+    SECTION("Minimized tables are only compared on words over the alphabet") {
+        // States 1 and 2 only cycle through each other, so minimizing merges
+        // them into an accepting sink that stops before the '#' Read reports
+        std::map<char, int> alphabet{{'a', 0}, {'b', 1}};
+        Automaton dfa(alphabet, {{1, 0}, {2, 2}, {1, 1}}, {1, 2});
+        vector<ReadResult> expected;
+        ReferenceRead(dfa, {"aa#"}, expected);
+        REQUIRE(expected[0] == ReadResult::InvalidSymbol);
+        REQUIRE(CompareEngines(dfa, {"aa#", "ab", "b"}).empty());
+    }
+
+    SECTION("Generated automata take the early exits") {
+        std::mt19937_64 rng(7);
+        size_t dead = 0;
+        size_t sinks = 0;
+        for (int round = 0; round < 20; round++) {
+            Automaton dfa = GenerateAutomaton(rng, 12, 4);
+            for (int s = 0; s < 12; s++) {
+                dead += dfa.IsDeadState(s);
+                sinks += dfa.IsAcceptingSink(s);
+            }
+        }
+        REQUIRE(dead > 0);
+        REQUIRE(sinks > 0);
+    }
+}
+
+TEST_CASE("Engines agree with Read on random automata", "[differential]") {
+    std::mt19937_64 rng(2049);
+    for (int round = 0; round < 200; round++) {
+        const size_t num_states = 1 + rng() % 40;
+        const size_t num_columns = 1 + rng() % 6;
+        Automaton dfa = GenerateAutomaton(rng, num_states, num_columns);
+        vector<string> words = GenerateWords(rng, dfa, 60, round % 10 == 0 ? 400 : 40);
+        vector<string_view> views = Views(words);
+
+        for (const auto& d : CompareEngines(dfa, views)) {
+            INFO("round " << round << ": " << d.Describe(views));
+            CHECK(false);
+        }
+    }
+}
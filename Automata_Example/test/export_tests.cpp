@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include "table_export.h"
+#include "buffered_writer.h"
+#include "test_automata.h"
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+using std::vector;
+using std::map;
+using std::string;
+
+TEST_CASE("Text export keeps the PrintTransitionTable layout", "[export]") {
+    std::ostringstream out;
+    ExportTable(EndsWithB(), out);
+    REQUIRE(out.str() ==
+        "Transition Table:\n"
+        "----------------\n"
+        "State | 'a' | 'b' |\n"
+        "------|-----|-----|\n"
+        "  0   |  0  |  1  |\n"
+        "  1   |  0  |  1  | (accepting)\n");
+}
+
+TEST_CASE("Graphviz and CSV export", "[export]") {
+    SECTION("DOT merges parallel edges") {
+        map<char, int> alphabet = {{'"', 0}, {'a', 1}, {'b', 2}};
+        Automaton dfa(alphabet, {{1, 1, 0}, {1, 1, 1}}, {1});
+        std::ostringstream out;
+        ExportTable(dfa, out, TableFormat::Dot);
+        string dot = out.str();
+
+        REQUIRE_THAT(dot, Catch::Matchers::StartsWith("digraph automaton {"));
+        REQUIRE_THAT(dot, Catch::Matchers::ContainsSubstring("start -> 0;"));
+        REQUIRE_THAT(dot, Catch::Matchers::ContainsSubstring("1 [shape=doublecircle];"));
+        REQUIRE_THAT(dot, Catch::Matchers::ContainsSubstring("0 -> 0 [label=\"b\"];"));
+        REQUIRE_THAT(dot, Catch::Matchers::ContainsSubstring("0 -> 1 [label=\"\\\",a\"];"));
+        REQUIRE_THAT(dot, Catch::Matchers::ContainsSubstring("1 -> 1 [label=\"\\\",a,b\"];"));
+    }
+
+    SECTION("CSV has one row per state") {
+        std::ostringstream out;
+        ExportTable(EndsWithB(), out, TableFormat::Csv);
+        REQUIRE(out.str() == "state,\"a\",\"b\",accepting\n0,0,1,0\n1,0,1,1\n");
+    }
+}
+
+TEST_CASE("Buffered writer", "[export]") {
+    std::ostringstream out;
+    {
+        BufferedWriter w(out, 4);
+        w.Write("ab");
+        w.WriteInt(-123);
+        w.Put('|');
+        REQUIRE(out.str() == "ab-123");  // '|' is still buffered
+        w.Write("a string longer than the buffer");
+    }
+    REQUIRE(out.str() == "ab-123|a string longer than the buffer");
+}
+
+TEST_CASE("File export reports write errors", "[export]") {
+    // /dev/full accepts the open and the buffered writes, then fails the flush in fclose
+    if (std::FILE* probe = std::fopen("/dev/full", "wb")) {
+        std::fclose(probe);
+        REQUIRE_THROWS_AS(ExportTableFile(EndsWithB(), "/dev/full", TableFormat::Csv), std::runtime_error);
+    }
+    REQUIRE_THROWS_AS(ExportTableFile(EndsWithB(), "/nonexistent/dir/table.csv", TableFormat::Csv),
+                      std::runtime_error);
+}
@@ -0,0 +1,118 @@
+// libFuzzer target comparing every ReadEngine with Automaton::Read.
+//
+// Build with -DAUTOMATA_ENABLE_FUZZING=ON and clang, then run e.g.
+//     ./bin/FuzzRead -max_len=4096 corpus/
+// Without the option the same target is built with a small main() that replays
+// the files given on the command line, so crashes can be reproduced with gcc.
+#include "differential.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Hands out the input one byte at a time, then zeros
+class ByteSource
+{
+public:
+    ByteSource(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint8_t Next() { return pos < size ? data[pos++] : 0; }
+    bool Empty() const { return pos >= size; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+};
+
+// Layout: state count, column count, then for each column its byte and a flag
+// for a second byte, the transitions, one accepting bit per state, and finally
+// words as (length, bytes) pairs.
+Automaton DecodeAutomaton(ByteSource& in)
+{
+    const size_t num_states = 1 + in.Next() % 32;
+    const size_t num_columns = 1 + in.Next() % 8;
+
+    std::array<uint16_t, 256> column_of;
+    column_of.fill(ByteClasses::kNoColumn);
+    auto claim = [&](uint8_t byte, size_t col) {
+        while (column_of[byte] != ByteClasses::kNoColumn) {
+            byte++;
+        }
+        column_of[byte] = static_cast<uint16_t>(col);
+    };
+    for (size_t col = 0; col < num_columns; col++) {
+        claim(in.Next(), col);
+        uint8_t extra = in.Next();
+        if (extra & 1) {
+            claim(static_cast<uint8_t>(extra >> 1), col);
+        }
+    }
+
+    std::vector<std::vector<int>> M(num_states, std::vector<int>(num_columns));
+    for (auto& row : M) {
+        for (auto& target : row) {
+            target = in.Next() % static_cast<int>(num_states);
+        }
+    }
+    std::vector<int> accepting;
+    for (size_t q = 0; q < num_states; q += 8) {
+        uint8_t bits = in.Next();
+        for (size_t k = 0; k < 8 && q + k < num_states; k++) {
+            if (bits & (1u << k)) {
+                accepting.push_back(static_cast<int>(q + k));
+            }
+        }
+    }
+    return Automaton(ByteClasses::FromTable(column_of, num_columns), std::move(M), std::move(accepting));
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    ByteSource in(data, size);
+    Automaton dfa = DecodeAutomaton(in);
+    std::vector<std::string> words;
+    while (!in.Empty()) {
+        std::string word(in.Next(), '\0');
+        for (auto& c : word) {
+            c = static_cast<char>(in.Next());
+        }
+        words.push_back(std::move(word));
+    }
+    std::vector<std::string_view> views(words.begin(), words.end());
+
+    auto disagreements = CompareEngines(dfa, views);
+    for (const auto& d : disagreements) {
+        std::fprintf(stderr, "%s\n", d.Describe(views).c_str());
+    }
+    if (!disagreements.empty()) {
+        std::abort();
+    }
+    return 0;
+}
+
+#ifndef AUTOMATA_LIBFUZZER
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 2;
+        }
+        std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+        std::printf("%s: ok\n", argv[i]);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include "incremental.h"
+#include "test_automata.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+TEST_CASE("Incremental matching", "[incremental]") {
+    // Number of b's is divisible by 3; never stops early, so every byte counts
+    Automaton mod3({{'a', 0}, {'b', 1}}, {{0, 1}, {1, 2}, {2, 0}}, {0});
+
+    SECTION("Small edits") {
+        IncrementalMatcher matcher(mod3, "abba", 2);
+        REQUIRE(matcher.Result() == ReadResult::Rejected);
+        matcher.Insert(4, "b");
+        REQUIRE(matcher.Text() == "abbab");
+        REQUIRE(matcher.Result() == ReadResult::Accepted);
+        matcher.Replace(1, 1, "?");
+        REQUIRE(matcher.Result() == ReadResult::InvalidSymbol);
+        matcher.Erase(1, 1);
+        REQUIRE(matcher.Text() == "abab");
+        REQUIRE(matcher.Result() == ReadResult::Rejected);
+        matcher.Erase(0, 100);
+        REQUIRE(matcher.Size() == 0);
+        REQUIRE(matcher.Result() == ReadResult::Accepted);
+        matcher.Insert(0, "bbbbbbbbb");
+        REQUIRE(matcher.Result() == ReadResult::Accepted);
+        REQUIRE_THROWS_AS(matcher.Insert(10, "a"), std::invalid_argument);
+        REQUIRE_THROWS_AS(IncrementalMatcher(mod3, "ab", 0), std::invalid_argument);
+    }
+
+    SECTION("Random edits agree with reading the whole text") {
+        std::mt19937 rng(45);
+        for (size_t segment_size : {size_t{1}, size_t{7}, size_t{64}}) {
+            string text = RandomText(rng, 500, "ab");
+            IncrementalMatcher matcher(mod3, text, segment_size);
+            for (int edit = 0; edit < 300; edit++) {
+                size_t pos = rng() % (text.size() + 1);
+                size_t count = rng() % 4 == 0 ? rng() % 200 : rng() % 3;
+                string replacement = RandomText(rng, rng() % 4 == 0 ? rng() % 150 : rng() % 3,
+                                                edit % 50 == 0 ? "ab!" : "ab");
+                text.replace(pos, count, replacement);
+                matcher.Replace(pos, count, replacement);
+                REQUIRE(matcher.Size() == text.size());
+                REQUIRE(matcher.Result() == ExpectedResult(mod3, text));
+            }
+            REQUIRE(matcher.Text() == text);
+        }
+    }
+
+    SECTION("Early exit states") {
+        // Accepting sink after "ab", dead state after "b" first
+        Automaton dfa({{'a', 0}, {'b', 1}}, {{1, 3}, {1, 2}, {2, 2}, {3, 3}}, {2});
+        IncrementalMatcher matcher(dfa, "aab?", 2);
+        REQUIRE(matcher.Result() == ExpectedResult(dfa, "aab?"));
+        matcher.Insert(0, "b");
+        REQUIRE(matcher.Result() == ExpectedResult(dfa, "baab?"));
+        matcher.Erase(0, 2);
+        REQUIRE(matcher.Result() == ExpectedResult(dfa, "ab?"));
+    }
+}
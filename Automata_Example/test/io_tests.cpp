@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include "automaton_io.h"
+#include <vector>
+#include <map>
+#include <sstream>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+void Put32(vector<uint8_t>& bytes, uint32_t v)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    bytes.insert(bytes.end(), p, p + 4);
+}
+
+// Appends the FNV-1a checksum SaveAutomatonBinary writes
+string Seal(vector<uint8_t> bytes)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t b : bytes) {
+        hash ^= b;
+        hash *= 1099511628211ull;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&hash);
+    bytes.insert(bytes.end(), p, p + 8);
+    return string(bytes.begin(), bytes.end());
+}
+
+} // namespace
+
+TEST_CASE("Text DFA format round trip", "[io]") {
+    std::istringstream in(
+        "# strings ending with 'b'\n"
+        "alphabet ab\n"
+        "accepting 1\n"
+        "0 1\n"
+        "\n"
+        "0 1\n");
+    Automaton dfa = LoadAutomaton(in);
+    REQUIRE(dfa.Read("aab"));
+    REQUIRE_FALSE(dfa.Read("ba"));
+
+    std::ostringstream out;
+    SaveAutomaton(out, dfa);
+    REQUIRE(out.str() == "alphabet ab\naccepting 1\n0 1\n0 1\n");
+
+    std::istringstream bad("alphabet ab\naccepting 1\n0 x\n");
+    REQUIRE_THROWS_AS(LoadAutomaton(bad), std::invalid_argument);
+
+    std::istringstream invalid_state("alphabet ab\naccepting 1\n0 2\n0 1\n");
+    REQUIRE_THROWS_WITH(LoadAutomaton(invalid_state),
+        Catch::Matchers::ContainsSubstring("Transition to invalid state"));
+}
+
+TEST_CASE("Checksummed binary DFA image", "[io]") {
+    map<char, int> alphabet = {{'0', 0}, {'1', 1}};
+    vector<vector<int>> transitions = {{0, 1}, {2, 0}, {1, 2}};
+    Automaton div3(alphabet, transitions, {0});
+
+    std::ostringstream out;
+    SaveAutomatonBinary(out, div3);
+    string image = out.str();
+
+    SECTION("Round trip") {
+        std::istringstream in(image);
+        Automaton loaded = LoadAutomatonBinary(in);
+        REQUIRE(loaded.GetTransitionMatrix() == transitions);
+        REQUIRE(loaded.GetAlphabet() == alphabet);
+        REQUIRE(loaded.Read("110"));
+        REQUIRE_FALSE(loaded.Read("111"));
+    }
+
+    SECTION("Corruption is detected by the checksum") {
+        image[image.size() / 2] ^= 0x01;
+        std::istringstream in(image);
+        REQUIRE_THROWS_WITH(LoadAutomatonBinary(in),
+            Catch::Matchers::ContainsSubstring("checksum mismatch"));
+    }
+
+    SECTION("Not an image") {
+        std::istringstream in("alphabet ab\n");
+        REQUIRE_THROWS_AS(LoadAutomatonBinary(in), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Trusted construction skips validation", "[io]") {
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+
+    // Accepting state 5 does not exist: rejected normally, not inspected when trusted
+    REQUIRE_THROWS_AS(Automaton(alphabet, {{0, 1}, {0, 1}}, {1, 5}), std::invalid_argument);
+
+    Automaton trusted(alphabet, {{0, 1}, {0, 1}}, {1}, Validation::Trusted);
+    REQUIRE(trusted.Read("ab"));
+    REQUIRE_FALSE(trusted.Read("ba"));
+}
+
+TEST_CASE("Validation errors on a large matrix", "[io]") {
+    // Big enough to be validated in several row ranges on multi-core machines
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+    const int n = 100000;
+    vector<vector<int>> transitions(n);
+    for (int i = 0; i < n; i++) {
+        transitions[static_cast<size_t>(i)] = {(i + 1) % n, 0};
+    }
+
+    SECTION("Valid matrix compiles") {
+        Automaton cycle(alphabet, transitions, {n - 1});
+        REQUIRE(cycle.Read(string(n - 1, 'a')));
+        REQUIRE_FALSE(cycle.Read(string(n, 'a')));
+    }
+
+    SECTION("The first bad row is reported") {
+        transitions[70000][1] = n;
+        transitions[90000][0] = -1;
+        transitions[30000].push_back(0);
+        REQUIRE_THROWS_WITH(Automaton(alphabet, transitions, {0}),
+            Catch::Matchers::ContainsSubstring("Each state must have a transition"));
+        transitions[30000].pop_back();
+        REQUIRE_THROWS_WITH(Automaton(alphabet, transitions, {0}),
+            Catch::Matchers::ContainsSubstring("from state 70000"));
+    }
+}
+
+TEST_CASE("Byte class alphabets in both formats", "[io]") {
+    // Identifiers: a letter or '_' followed by letters, digits and '_'
+    Automaton ident(ByteClasses::Parse({"[a-zA-Z_]", "[0-9]", "[ \\t]"}),
+                    {{1, 2, 2}, {1, 1, 2}, {2, 2, 2}}, {1});
+
+    SECTION("Text") {
+        std::ostringstream out;
+        SaveAutomaton(out, ident);
+        REQUIRE(out.str() == "classes [A-Z_a-z] [0-9] [\\x09\\x20]\naccepting 1\n1 2 2\n1 1 2\n2 2 2\n");
+
+        std::istringstream in(out.str());
+        Automaton loaded = LoadAutomaton(in);
+        REQUIRE(loaded.GetNumColumns() == 3);
+        REQUIRE(loaded.Read("_x9"));
+        REQUIRE_FALSE(loaded.Read("9x"));
+        REQUIRE_FALSE(loaded.Read("a b"));
+
+        std::istringstream both("alphabet ab\nclasses [ab]\naccepting\n0\n");
+        REQUIRE_THROWS_AS(LoadAutomaton(both), std::invalid_argument);
+    }
+
+    SECTION("A column no byte maps to") {
+        // The map form only requires column values below the map size
+        Automaton unused({{'a', 0}, {'b', 0}}, {{1, 0}, {0, 1}}, {1});
+        std::ostringstream out;
+        SaveAutomaton(out, unused);
+        REQUIRE(out.str() == "classes [ab] []\naccepting 1\n1 0\n0 1\n");
+
+        std::istringstream in(out.str());
+        Automaton loaded = LoadAutomaton(in);
+        REQUIRE(loaded.GetNumColumns() == 2);
+        REQUIRE(loaded.GetByteClasses().Table() == unused.GetByteClasses().Table());
+        REQUIRE(loaded.Read("bab"));
+        REQUIRE_FALSE(loaded.Read("ab"));
+    }
+
+    SECTION("Binary") {
+        std::stringstream image;
+        SaveAutomatonBinary(image, ident);
+        Automaton loaded = LoadAutomatonBinary(image);
+        REQUIRE(loaded.GetByteClasses().Table() == ident.GetByteClasses().Table());
+        REQUIRE(loaded.Read("Abc_12"));
+        REQUIRE_FALSE(loaded.Read("1"));
+    }
+
+    SECTION("Version 1 images still load") {
+        // magic, version 1, 2 columns, ('a', 0), ('b', 1), 1 state, 1 accepting: 0, row 0 0
+        vector<uint8_t> bytes = {'D', 'F', 'A', 'B'};
+        Put32(bytes, 1);
+        Put32(bytes, 2);
+        bytes.push_back('a');
+        Put32(bytes, 0);
+        bytes.push_back('b');
+        Put32(bytes, 1);
+        Put32(bytes, 1);
+        Put32(bytes, 1);
+        Put32(bytes, 0);
+        Put32(bytes, 0);
+        Put32(bytes, 0);
+
+        std::istringstream in(Seal(bytes));
+        Automaton loaded = LoadAutomatonBinary(in);
+        REQUIRE(loaded.Read("abba"));
+        REQUIRE(loaded.GetAlphabet() == map<char, int>{{'a', 0}, {'b', 1}});
+    }
+}
+
+TEST_CASE("Binary image counts are checked before allocating", "[io]") {
+    SECTION("More accepting states than the image holds") {
+        // Version 1, 1 column ('a', 0), 1 state, 2^32 - 1 accepting states
+        vector<uint8_t> bytes = {'D', 'F', 'A', 'B'};
+        Put32(bytes, 1);
+        Put32(bytes, 1);
+        bytes.push_back('a');
+        Put32(bytes, 0);
+        Put32(bytes, 1);
+        Put32(bytes, 0xFFFFFFFF);
+        Put32(bytes, 0);
+        std::istringstream in(Seal(bytes));
+        REQUIRE_THROWS_WITH(LoadAutomatonBinary(in), Catch::Matchers::ContainsSubstring("truncated"));
+    }
+
+    SECTION("More columns than bytes in a version 1 image") {
+        vector<uint8_t> bytes = {'D', 'F', 'A', 'B'};
+        Put32(bytes, 1);
+        Put32(bytes, 257);
+        for (uint32_t i = 0; i < 257; i++) {
+            bytes.push_back(static_cast<uint8_t>(i));
+            Put32(bytes, i);
+        }
+        Put32(bytes, 0);
+        Put32(bytes, 0);
+        std::istringstream in(Seal(bytes));
+        REQUIRE_THROWS_WITH(LoadAutomatonBinary(in), Catch::Matchers::ContainsSubstring("too many columns"));
+    }
+}
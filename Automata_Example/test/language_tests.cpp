@@ -0,0 +1,188 @@
+#include <catch2/catch_test_macros.hpp>
+#include "language.h"
+#include "test_automata.h"
+#include <vector>
+#include <map>
+#include <random>
+
+using std::vector;
+using std::map;
+
+namespace {
+
+const map<char, int> kAB = {{'a', 0}, {'b', 1}};
+
+// The same language with redundant states
+Automaton EndsWithBRedundant()
+{
+    return Automaton(kAB, {{2, 1}, {2, 3}, {2, 1}, {0, 3}}, {1, 3});
+}
+
+// Strings with an even number of 'a's
+Automaton EvenAs()
+{
+    return Automaton(kAB, {{1, 0}, {0, 1}}, {0});
+}
+
+} // namespace
+
+TEST_CASE("Equivalence checking", "[language]") {
+    SECTION("Equivalent automata with different state counts") {
+        REQUIRE(AreEquivalent(EndsWithB(), EndsWithBRedundant()));
+        REQUIRE_FALSE(FindDifference(EndsWithB(), EndsWithBRedundant()).has_value());
+    }
+
+    SECTION("Shortest counterexample") {
+        auto difference = FindDifference(EndsWithB(), EvenAs());
+        REQUIRE_FALSE(AreEquivalent(EndsWithB(), EvenAs()));
+        REQUIRE(difference.has_value());
+        REQUIRE(difference->empty());  // "" is in EvenAs only
+
+        // "ends with b" vs "ends with b, length >= 2" differ first on "b"
+        Automaton long_ends_with_b(kAB, {{1, 1}, {1, 2}, {1, 2}}, {2});
+        difference = FindDifference(EndsWithB(), long_ends_with_b);
+        REQUIRE(difference == std::optional<std::string>("b"));
+    }
+
+    SECTION("Different alphabets") {
+        // Over {a, b} only 'a's are accepted; the other automaton also knows 'c'
+        Automaton only_as(kAB, {{0, 1}, {1, 1}}, {0});
+        Automaton only_as_abc({{'a', 0}, {'b', 1}, {'c', 2}}, {{0, 1, 1}, {1, 1, 1}}, {0});
+        REQUIRE(AreEquivalent(only_as, only_as_abc));
+
+        Automaton accepts_c({{'a', 0}, {'c', 1}}, {{0, 0}}, {0});
+        REQUIRE(FindDifference(only_as, accepts_c) == std::optional<std::string>("c"));
+    }
+}
+
+TEST_CASE("Inclusion checking", "[language]") {
+    // Strings ending with "bb" are a subset of strings ending with 'b'
+    Automaton ends_with_bb(kAB, {{0, 1}, {0, 2}, {0, 2}}, {2});
+    REQUIRE(IsSubsetOf(ends_with_bb, EndsWithB()));
+    REQUIRE_FALSE(IsSubsetOf(EndsWithB(), ends_with_bb));
+    REQUIRE(FindInclusionCounterexample(EndsWithB(), ends_with_bb) == std::optional<std::string>("b"));
+
+    // Empty language is included in everything
+    Automaton empty(kAB, {{0, 0}}, {});
+    REQUIRE(IsSubsetOf(empty, EvenAs()));
+    REQUIRE(FindInclusionCounterexample(EvenAs(), empty) == std::optional<std::string>(""));
+}
+
+namespace {
+
+// Every word over `symbols` up to length `max_length`
+std::vector<std::string> AllWords(const std::string& symbols, size_t max_length)
+{
+    std::vector<std::string> words{""};
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i].size() == max_length) {
+            continue;
+        }
+        for (char c : symbols) {
+            words.push_back(words[i] + c);
+        }
+    }
+    return words;
+}
+
+// Read that treats symbols outside the alphabet as rejection
+bool Accepts(Automaton dfa, const std::string& word)
+{
+    try {
+        return dfa.Read(word);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+} // namespace
+
+TEST_CASE("Product constructions", "[language]") {
+    Automaton ends_with_b = EndsWithB();
+    Automaton even_as = EvenAs();
+    // Words over {b, c} with no "cc"
+    Automaton no_cc({{'b', 0}, {'c', 1}}, {{0, 1}, {0, 2}, {2, 2}}, {0, 1});
+
+    Automaton both = Intersection(ends_with_b, even_as);
+    Automaton either = Union(ends_with_b, no_cc);
+    Automaton only_first = Difference(ends_with_b, even_as);
+    Automaton not_even = Complement(even_as);
+
+    for (const auto& word : AllWords("abc", 6)) {
+        bool in_b = Accepts(ends_with_b, word);
+        bool in_even = Accepts(even_as, word);
+        bool in_no_cc = Accepts(no_cc, word);
+        CAPTURE(word);
+        REQUIRE(Accepts(both, word) == (in_b && in_even));
+        REQUIRE(Accepts(either, word) == (in_b || in_no_cc));
+        REQUIRE(Accepts(only_first, word) == (in_b && !in_even));
+        if (word.find('c') == std::string::npos) {
+            REQUIRE(Accepts(not_even, word) == !in_even);
+        }
+    }
+
+    // The product of two 2-state automata needs at most 4 states (+1 dead for 'c')
+    REQUIRE(both.GetNumStates() <= 5);
+    REQUIRE(AreEquivalent(Intersection(ends_with_b, ends_with_b), ends_with_b));
+}
+
+TEST_CASE("Products keep byte classes", "[language]") {
+    // Lower-case words, and words without 'q': one column each
+    Automaton letters(ByteClasses::Parse({"[a-z]"}), {{0}}, {0});
+    Automaton no_q(ByteClasses::Parse({"[^q]"}), {{0}}, {0});
+
+    // Bytes fall into [a-z] but not q, q, and the other non-letters
+    Automaton both = Intersection(letters, no_q);
+    REQUIRE(both.GetNumColumns() == 3);
+    REQUIRE(Union(letters, no_q).GetNumColumns() == 3);
+    REQUIRE(Accepts(both, "abz"));
+    REQUIRE_FALSE(Accepts(both, "aqz"));
+    REQUIRE_FALSE(Accepts(both, "a1"));
+    REQUIRE(Accepts(Difference(no_q, letters), "1 !"));
+
+    REQUIRE(AreEquivalent(both, Intersection(no_q, letters)));
+    REQUIRE(FindDifference(letters, both) == std::optional<std::string>("q"));
+    REQUIRE(IsSubsetOf(both, letters));
+}
+
+TEST_CASE("Minimization", "[language]") {
+    Automaton minimal = Minimize(EndsWithBRedundant());
+    REQUIRE(minimal.GetNumStates() == 2);
+    REQUIRE(AreEquivalent(minimal, EndsWithB()));
+
+    SECTION("Unreachable states are dropped") {
+        Automaton with_unreachable(kAB, {{0, 0}, {1, 0}, {2, 2}}, {0, 2});
+        Automaton universal = Minimize(with_unreachable);
+        REQUIRE(universal.GetNumStates() == 1);
+        REQUIRE(universal.Read("abba"));
+    }
+
+    SECTION("Already minimal automaton keeps its size") {
+        // Binary numbers divisible by 3
+        Automaton div3({{'0', 0}, {'1', 1}}, {{0, 1}, {2, 0}, {1, 2}}, {0});
+        Automaton same = Minimize(div3);
+        REQUIRE(same.GetNumStates() == 3);
+        REQUIRE(AreEquivalent(same, div3));
+        REQUIRE(same.Read("110"));
+    }
+
+    SECTION("Random automata stay equivalent") {
+        std::mt19937 rng(11);
+        for (int round = 0; round < 20; round++) {
+            size_t n = 1 + rng() % 60;
+            vector<vector<int>> transitions(n, vector<int>(2));
+            vector<int> accepting;
+            for (size_t i = 0; i < n; i++) {
+                transitions[i] = {static_cast<int>(rng() % n), static_cast<int>(rng() % n)};
+                if (rng() % 3 == 0) {
+                    accepting.push_back(static_cast<int>(i));
+                }
+            }
+            Automaton dfa(kAB, transitions, accepting);
+            Automaton minimal = Minimize(dfa);
+            REQUIRE(AreEquivalent(dfa, minimal));
+            REQUIRE(minimal.GetNumStates() <= n);
+            REQUIRE(Minimize(minimal).GetNumStates() == minimal.GetNumStates());
+        }
+    }
+}
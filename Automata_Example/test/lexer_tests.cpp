@@ -0,0 +1,170 @@
+#include <catch2/catch_test_macros.hpp>
+#include "lexer.h"
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <random>
+#include <string>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// Accepts exactly `literal`; state literal.size() + 1 is dead
+Automaton Literal(const string& literal)
+{
+    map<char, int> alphabet;
+    for (char c : literal) {
+        alphabet.emplace(c, static_cast<int>(alphabet.size()));
+    }
+    const int dead = static_cast<int>(literal.size()) + 1;
+    vector<vector<int>> M(literal.size() + 2, vector<int>(alphabet.size(), dead));
+    for (size_t i = 0; i < literal.size(); i++) {
+        M[i][static_cast<size_t>(alphabet[literal[i]])] = static_cast<int>(i) + 1;
+    }
+    return Automaton(alphabet, M, {static_cast<int>(literal.size())});
+}
+
+// One or more characters from [first, last]
+Automaton OneOrMore(char first, char last)
+{
+    map<char, int> alphabet;
+    for (char c = first; c <= last; c++) {
+        alphabet[c] = c - first;
+    }
+    vector<vector<int>> M(2, vector<int>(alphabet.size(), 1));
+    return Automaton(alphabet, M, {1});
+}
+
+bool SameTokens(const vector<Token>& a, const vector<Token>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].kind != b[i].kind || a[i].offset != b[i].offset || a[i].length != b[i].length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Maximal munch by trying every rule on every prefix
+size_t ReferenceTokenize(vector<Automaton> rules, const string& text, vector<Token>& tokens)
+{
+    tokens.clear();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        Token best{-1, pos, 0};
+        for (size_t r = 0; r < rules.size(); r++) {
+            for (size_t len = text.size() - pos; len > best.length; len--) {
+                string word = text.substr(pos, len);
+                const auto& alphabet = rules[r].GetAlphabet();
+                bool in_alphabet = std::all_of(word.begin(), word.end(),
+                                               [&](char c) { return alphabet.count(c) != 0; });
+                if (in_alphabet && rules[r].Read(word)) {
+                    best = Token{static_cast<int>(r), pos, len};
+                    break;
+                }
+            }
+        }
+        if (best.length == 0) {
+            return pos;
+        }
+        tokens.push_back(best);
+        pos += best.length;
+    }
+    return pos;
+}
+
+} // namespace
+
+TEST_CASE("Lexer maximal munch", "[lexer]") {
+    enum Kind { If, Identifier, Number, Space };
+    Lexer lexer({Literal("if"), OneOrMore('a', 'z'), OneOrMore('0', '9'), OneOrMore(' ', ' ')});
+    vector<Token> tokens;
+
+    SECTION("Keywords win ties, longer identifiers win over keywords") {
+        string text = "if iff  x 42";
+        REQUIRE(lexer.Tokenize(text, tokens) == text.size());
+        vector<Token> expected = {
+            {If, 0, 2}, {Space, 2, 1}, {Identifier, 3, 3}, {Space, 6, 2},
+            {Identifier, 8, 1}, {Space, 9, 1}, {Number, 10, 2},
+        };
+        REQUIRE(SameTokens(tokens, expected));
+    }
+
+    SECTION("Stops where no rule matches") {
+        REQUIRE(lexer.Tokenize("x = 1", tokens) == 2);
+        REQUIRE(tokens.size() == 2);
+        REQUIRE(lexer.Tokenize("", tokens) == 0);
+        REQUIRE(tokens.empty());
+    }
+
+    SECTION("The token vector is reused") {
+        lexer.Tokenize("a b c d e f", tokens);
+        auto capacity = tokens.capacity();
+        lexer.Tokenize("if", tokens);
+        REQUIRE(tokens.size() == 1);
+        REQUIRE(tokens.capacity() == capacity);
+    }
+}
+
+TEST_CASE("Lexer columns are the joint byte classes of its rules", "[lexer]") {
+    // Words, and runs of anything else: two columns however many bytes they span
+    Automaton word(ByteClasses::Parse({"[a-z]"}), {{1}, {1}}, {1});
+    Automaton other(ByteClasses::Parse({"[^a-z]"}), {{1}, {1}}, {1});
+    Lexer lexer({word, other});
+    REQUIRE(lexer.GetNumColumns() == 2);
+
+    vector<Token> tokens;
+    string text = "ab, c\xff!";
+    REQUIRE(lexer.Tokenize(text, tokens) == text.size());
+    REQUIRE(SameTokens(tokens, {{0, 0, 2}, {1, 2, 2}, {0, 4, 1}, {1, 5, 2}}));
+
+    // Overlapping classes split into the pieces the rules tell apart
+    Lexer split({Literal("if"), OneOrMore('a', 'z')});
+    REQUIRE(split.GetNumColumns() == 3);
+}
+
+TEST_CASE("Lexer backs up to the last accepting position", "[lexer]") {
+    Lexer lexer({Literal("a"), Literal("b"), Literal("abc")});
+    vector<Token> tokens;
+    REQUIRE(lexer.Tokenize("abaabc", tokens) == 6);
+    REQUIRE(SameTokens(tokens, {{0, 0, 1}, {1, 1, 1}, {0, 2, 1}, {2, 3, 3}}));
+}
+
+TEST_CASE("Lexer agrees with a rule-by-rule reference", "[lexer]") {
+    std::mt19937 rng(38);
+    const map<char, int> ab = {{'a', 0}, {'b', 1}};
+    for (int trial = 0; trial < 30; trial++) {
+        vector<Automaton> rules;
+        size_t num_rules = 1 + static_cast<size_t>(trial % 4);
+        for (size_t r = 0; r < num_rules; r++) {
+            int n = 2 + static_cast<int>(rng() % 4);
+            vector<vector<int>> M(static_cast<size_t>(n), vector<int>(2));
+            vector<int> accepting;
+            for (int q = 0; q < n; q++) {
+                M[static_cast<size_t>(q)] = {static_cast<int>(rng() % static_cast<unsigned>(n)),
+                                             static_cast<int>(rng() % static_cast<unsigned>(n))};
+                if (rng() % 3 == 0) {
+                    accepting.push_back(q);
+                }
+            }
+            rules.emplace_back(ab, M, accepting);
+        }
+        // A rule over 'c' alone, so texts can contain bytes some rules lack
+        rules.push_back(Literal("c"));
+
+        string text;
+        for (int i = 0; i < 40; i++) {
+            text += "abc"[rng() % 3];
+        }
+        vector<Token> tokens, expected;
+        Lexer lexer(rules);
+        REQUIRE(lexer.Tokenize(text, tokens) == ReferenceTokenize(rules, text, expected));
+        REQUIRE(SameTokens(tokens, expected));
+    }
+}
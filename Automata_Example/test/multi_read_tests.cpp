@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+#include "multi_read.h"
+#include "test_automata.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using std::vector;
+using std::map;
+using std::string;
+
+TEST_CASE("ReadMany agrees with Read", "[multi_read]") {
+    std::mt19937 rng(41);
+    const map<char, int> alphabet = {{'a', 0}, {'b', 1}, {'c', 2}};
+    for (int trial = 0; trial < 20; trial++) {
+        // Small random automata have plenty of dead states and accepting sinks
+        int n = 1 + trial % 9;
+        vector<vector<int>> M(static_cast<size_t>(n), vector<int>(3));
+        vector<int> accepting;
+        for (size_t q = 0; q < M.size(); q++) {
+            for (int& target : M[q]) {
+                target = static_cast<int>(rng() % static_cast<unsigned>(n));
+            }
+            if (rng() % 2 == 0) {
+                accepting.push_back(static_cast<int>(q));
+            }
+        }
+        Automaton dfa(alphabet, M, accepting);
+
+        // Mostly valid words of very different lengths, some with a foreign 'x'
+        vector<string> storage;
+        for (int i = 0; i < 200; i++) {
+            size_t length = rng() % 4 == 0 ? rng() % 3 : rng() % 150;
+            string word;
+            for (size_t j = 0; j < length; j++) {
+                word += rng() % 60 == 0 ? 'x' : "abc"[rng() % 3];
+            }
+            storage.push_back(word);
+        }
+        vector<std::string_view> words(storage.begin(), storage.end());
+        vector<ReadResult> expected;
+        for (const string& word : storage) {
+            expected.push_back(ExpectedResult(dfa, word));
+        }
+
+        vector<ReadResult> results;
+        for (size_t lanes = 1; lanes <= 16; lanes++) {
+            ReadMany(dfa, words, results, lanes);
+            REQUIRE(results == expected);
+        }
+    }
+}
+
+TEST_CASE("ReadMany edge cases", "[multi_read]") {
+    Automaton ends_with_b({{'a', 0}, {'b', 1}}, {{0, 1}, {0, 1}}, {1});
+    vector<ReadResult> results = {ReadResult::Accepted};
+
+    ReadMany(ends_with_b, {}, results);
+    REQUIRE(results.empty());
+
+    ReadMany(ends_with_b, {"ab", "", "ba", "b"}, results, 16);
+    REQUIRE(results == vector<ReadResult>{ReadResult::Accepted, ReadResult::Rejected,
+                                          ReadResult::Rejected, ReadResult::Accepted});
+
+    REQUIRE_THROWS_AS(ReadMany(ends_with_b, {"a"}, results, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(ReadMany(ends_with_b, {"a"}, results, 17), std::invalid_argument);
+}
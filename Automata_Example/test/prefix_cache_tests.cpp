@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include "prefix_cache.h"
+#include "test_automata.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// Paths built from a few shared directories
+vector<string> RandomPaths(std::mt19937& rng, size_t count)
+{
+    vector<string> parts = {"aaab/", "ba.b/", "abababab/", "b/", "a.a.a.a.a/"};
+    vector<string> words;
+    for (size_t i = 0; i < count; i++) {
+        string word = "/";
+        size_t depth = 1 + rng() % 8;
+        for (size_t d = 0; d < depth; d++) {
+            word += parts[rng() % parts.size()];
+        }
+        word += string(rng() % 5, "ab"[rng() % 2]);
+        words.push_back(word);
+    }
+    return words;
+}
+
+} // namespace
+
+TEST_CASE("Prefix cache", "[prefix_cache]") {
+    std::mt19937 rng(47);
+
+    SECTION("Agrees with Read under eviction") {
+        for (size_t max_bytes : {size_t{1} << 20, size_t{2000}, size_t{1}}) {
+            for (size_t granularity : {size_t{1}, size_t{4}, size_t{16}}) {
+                Automaton dfa = RandomAutomaton(rng, 30, "ab/.");
+                PrefixCache cache(dfa, max_bytes, granularity);
+                for (const auto& word : RandomPaths(rng, 500)) {
+                    REQUIRE(cache.Read(word) == dfa.Read(word));
+                    REQUIRE(cache.GetNumEntries() <= cache.GetMaxEntries());
+                }
+            }
+        }
+    }
+
+    SECTION("Shared prefixes are hits") {
+        Automaton dfa = RandomAutomaton(rng, 30, "ab/.");
+        PrefixCache cache(dfa, 1 << 20, 4);
+        string prefix = "/aaab/ba.b/abababab/";
+        REQUIRE(cache.Read(prefix + "a") == dfa.Read(prefix + "a"));
+        REQUIRE(cache.GetStats().hits == 0);
+        REQUIRE(cache.GetNumEntries() == 5);
+        REQUIRE(cache.Read(prefix + "bb") == dfa.Read(prefix + "bb"));
+        REQUIRE(cache.GetStats().hits == 1);
+        REQUIRE(cache.GetStats().bytes_skipped == 20);
+        REQUIRE(cache.GetStats().HitRate() == 0.5);
+
+        cache.ResetStats();
+        cache.Clear();
+        REQUIRE(cache.GetNumEntries() == 0);
+        cache.Read(prefix);
+        REQUIRE(cache.GetStats().hits == 0);
+    }
+
+    SECTION("Least recently used leaves go first") {
+        Automaton dfa = RandomAutomaton(rng, 30, "ab/.");
+        // Room for three checkpoints of 4 bytes
+        PrefixCache probe(dfa, 1 << 20, 4);
+        size_t per_node = (size_t{1} << 20) / probe.GetMaxEntries();
+        PrefixCache cache(dfa, 3 * per_node + per_node / 2, 4);
+        REQUIRE(cache.GetMaxEntries() == 3);
+        cache.Read("/a/b/aa.");   // two checkpoints
+        cache.Read("/b/a");       // one more: full
+        cache.Read("/a/b/aa.");   // both hits, now newer than "/b/a"
+        cache.Read("/bab");       // evicts "/b/a"
+        REQUIRE(cache.GetStats().evictions == 1);
+        cache.ResetStats();
+        cache.Read("/a/b/aa.b");
+        REQUIRE(cache.GetStats().bytes_skipped == 8);
+        cache.Read("/b/a");       // evicted, so a miss
+        REQUIRE(cache.GetStats().hits == 1);
+    }
+
+    SECTION("Invalid symbols throw like Read") {
+        Automaton dfa = RandomAutomaton(rng, 30, "ab/.");
+        PrefixCache cache(dfa, 1 << 20, 2);
+        string word = "/aaab/x/b";
+        string expected;
+        try {
+            dfa.Read(word);
+        } catch (const std::invalid_argument& e) {
+            expected = e.what();
+        }
+        if (!expected.empty()) {
+            for (int round = 0; round < 2; round++) {
+                try {
+                    cache.Read(word);
+                    FAIL("no exception");
+                } catch (const std::invalid_argument& e) {
+                    REQUIRE(string(e.what()) == expected);
+                }
+            }
+        }
+        REQUIRE_THROWS_AS(PrefixCache(dfa, 1 << 20, 0), std::invalid_argument);
+    }
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+#include "range_matcher.h"
+#include "test_automata.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+TEST_CASE("Range acceptance queries", "[range_matcher]") {
+    std::mt19937 rng(46);
+
+    SECTION("Random ranges agree with Read") {
+        for (int trial = 0; trial < 8; trial++) {
+            Automaton dfa = RandomAutomaton(rng, 2 + trial * 5);
+            string buffer(5000 + rng() % 3000, 'a');
+            for (auto& c : buffer) {
+                c = "abc"[rng() % 3];
+            }
+            if (trial % 2 == 1) {
+                buffer[rng() % buffer.size()] = '#';
+            }
+            // Small budgets force several block sizes, down to one block
+            size_t budget = trial < 4 ? size_t{64} << 20 : size_t{4096} << (trial - 4);
+            RangeMatcher matcher(dfa, buffer, budget);
+            if (matcher.GetBlockSize() > 64) {
+                REQUIRE(matcher.MemoryBytes() <= budget);
+            }
+
+            vector<std::pair<size_t, size_t>> ranges;
+            for (int q = 0; q < 300; q++) {
+                size_t begin = rng() % (buffer.size() + 1);
+                size_t end = begin + rng() % (buffer.size() - begin + 1);
+                ranges.emplace_back(begin, end);
+            }
+            ranges.emplace_back(0, buffer.size());
+            ranges.emplace_back(0, 0);
+            ranges.emplace_back(buffer.size(), buffer.size());
+
+            vector<ReadResult> results;
+            matcher.QueryMany(ranges, results);
+            for (size_t i = 0; i < ranges.size(); i++) {
+                auto [begin, end] = ranges[i];
+                ReadResult expected = ExpectedResult(dfa, buffer.substr(begin, end - begin));
+                REQUIRE(matcher.Query(begin, end) == expected);
+                REQUIRE(results[i] == expected);
+            }
+        }
+    }
+
+    SECTION("Block size follows the memory budget") {
+        Automaton dfa = RandomAutomaton(rng, 50);
+        string buffer(1 << 16, 'a');
+        RangeMatcher fine(dfa, buffer);
+        RangeMatcher coarse(dfa, buffer, 1 << 14);
+        REQUIRE(fine.GetBlockSize() == 64);
+        REQUIRE(coarse.GetBlockSize() > fine.GetBlockSize());
+        REQUIRE(coarse.MemoryBytes() <= (1 << 14));
+        REQUIRE(coarse.Query(3, 60000) == fine.Query(3, 60000));
+    }
+
+    SECTION("Invalid ranges") {
+        Automaton dfa = RandomAutomaton(rng, 4);
+        string buffer = "abcabc";
+        RangeMatcher matcher(dfa, buffer);
+        REQUIRE_THROWS_AS(matcher.Query(4, 3), std::invalid_argument);
+        REQUIRE_THROWS_AS(matcher.Query(0, 7), std::invalid_argument);
+    }
+}
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+#include "result_cache.h"
+#include "test_automata.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// Mostly valid, with the occasional byte outside the alphabet
+const string kSymbols = "abcabcabc!";
+
+ReadResult Expected(Automaton dfa, const string& word, uint32_t& state)
+{
+    try {
+        bool accepted = dfa.Read(word);
+        // Automaton has no accessor for its current state; walk the matrix one
+        // symbol at a time, independently of the table and its early exits.
+        // Read only skips bytes after a sink, where the walk would stay anyway.
+        const auto& M = dfa.GetTransitionMatrix();
+        const ByteClasses& classes = dfa.GetByteClasses();
+        int q = dfa.GetInitialState();
+        for (char c : word) {
+            if (!classes.Contains(c)) {
+                break;
+            }
+            q = M[static_cast<size_t>(q)][static_cast<size_t>(classes.ColumnOf(c))];
+        }
+        state = static_cast<uint32_t>(q);
+        return accepted ? ReadResult::Accepted : ReadResult::Rejected;
+    } catch (const std::invalid_argument&) {
+        return ReadResult::InvalidSymbol;
+    }
+}
+
+} // namespace
+
+TEST_CASE("Result cache", "[result_cache]") {
+    std::mt19937 rng(48);
+
+    SECTION("Cached results match Read") {
+        Automaton dfa = RandomAutomaton(rng, 40);
+        ResultCache cache(dfa, 1 << 16, 12);
+        vector<string> words;
+        for (int i = 0; i < 300; i++) {
+            words.push_back(RandomText(rng, rng() % 17, kSymbols));
+        }
+        for (int round = 0; round < 3; round++) {
+            for (const auto& word : words) {
+                uint32_t expected_state = 0;
+                uint32_t state = 0;
+                ReadResult expected = Expected(dfa, word, expected_state);
+                REQUIRE(cache.Read(word, &state) == expected);
+                if (expected != ReadResult::InvalidSymbol) {
+                    REQUIRE(state == expected_state);
+                }
+            }
+        }
+        auto stats = cache.GetStats();
+        REQUIRE(stats.hits + stats.misses + stats.bypassed == 900);
+        REQUIRE(stats.bypassed > 0);
+        REQUIRE(stats.hits > stats.misses);
+    }
+
+    SECTION("The state after a cycle of accepting states is exact") {
+        Automaton dfa({{'a', 0}, {'b', 1}}, {{1, 0}, {2, 2}, {1, 1}}, {1, 2});
+        ResultCache cache(dfa);
+        for (int round = 0; round < 2; round++) {
+            uint32_t state = 0;
+            REQUIRE(cache.Read("aa", &state) == ReadResult::Accepted);
+            REQUIRE(state == 2);
+            REQUIRE(cache.Read("aab", &state) == ReadResult::Accepted);
+            REQUIRE(state == 1);
+        }
+    }
+
+    SECTION("Eviction keeps the cache within its slots") {
+        Automaton dfa = RandomAutomaton(rng, 10);
+        ResultCache cache(dfa, 4096, 8);
+        REQUIRE(cache.GetCapacity() <= 128);
+        for (int i = 0; i < 5000; i++) {
+            string word = RandomText(rng, rng() % 9, kSymbols);
+            uint32_t expected_state = 0;
+            REQUIRE(cache.Read(word) == Expected(dfa, word, expected_state));
+        }
+        auto stats = cache.GetStats();
+        REQUIRE(stats.evictions > 0);
+        REQUIRE(stats.misses - stats.evictions <= cache.GetCapacity());
+
+        cache.Clear();
+        REQUIRE(cache.GetStats().hits == 0);
+        cache.Read("ab");
+        cache.Read("ab");
+        REQUIRE(cache.GetStats().hits == 1);
+    }
+
+    SECTION("Hot words survive a stream of one-off words") {
+        Automaton dfa = RandomAutomaton(rng, 10);
+        ResultCache cache(dfa, 1 << 14, 16);
+        vector<string> hot = {"abc", "cab", "bbbb", "a"};
+        for (int i = 0; i < 20000; i++) {
+            cache.Read(hot[static_cast<size_t>(i) % hot.size()]);
+            cache.Read(std::to_string(i));  // invalid, but still cached
+        }
+        REQUIRE(cache.GetStats().hits >= 20000 - 4 * 10);
+    }
+
+    SECTION("Shared between threads") {
+        Automaton dfa = RandomAutomaton(rng, 40);
+        ResultCache cache(dfa, 1 << 15, 10);
+        vector<string> words;
+        vector<ReadResult> expected;
+        for (int i = 0; i < 500; i++) {
+            words.push_back(RandomText(rng, rng() % 11, kSymbols));
+            uint32_t state = 0;
+            expected.push_back(Expected(dfa, words.back(), state));
+        }
+        vector<int> mismatches(4, 0);
+        vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 local(static_cast<unsigned>(t));
+                for (int i = 0; i < 20000; i++) {
+                    size_t k = local() % words.size();
+                    mismatches[t] += cache.Read(words[k]) != expected[k];
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(mismatches == vector<int>(4, 0));
+        REQUIRE(cache.GetStats().hits + cache.GetStats().misses == 80000);
+    }
+
+    SECTION("Word length limit") {
+        Automaton dfa = RandomAutomaton(rng, 4);
+        REQUIRE_THROWS_AS(ResultCache(dfa, 1 << 20, 70000), std::invalid_argument);
+    }
+}
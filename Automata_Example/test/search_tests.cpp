@@ -0,0 +1,189 @@
+#include <catch2/catch_test_macros.hpp>
+#include "search.h"
+#include "test_automata.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <string>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// Leftmost-longest by trying every start in turn
+std::optional<Match> BruteForceFind(const Automaton& dfa, const string& text, size_t from)
+{
+    const auto& M = dfa.GetTransitionMatrix();
+    vector<bool> accepting(M.size(), false);
+    for (int q : dfa.GetAcceptingStates()) {
+        accepting[static_cast<size_t>(q)] = true;
+    }
+    for (size_t start = from; start <= text.size(); start++) {
+        std::optional<Match> longest;
+        int q = dfa.GetInitialState();
+        for (size_t i = start; ; i++) {
+            if (accepting[static_cast<size_t>(q)]) {
+                longest = Match{start, i};
+            }
+            int col = i < text.size() ? dfa.GetByteClasses().ColumnOf(text[i]) : -1;
+            if (col < 0) {
+                break;
+            }
+            q = M[static_cast<size_t>(q)][static_cast<size_t>(col)];
+        }
+        if (longest) {
+            return longest;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+TEST_CASE("Searcher finds every occurrence of a word", "[search]") {
+    // Accepts exactly "ab"
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+    vector<vector<int>> transitions = {
+        {1, 3},  // State 0: 'a' -> 1
+        {3, 2},  // State 1: 'b' -> 2
+        {3, 3},  // State 2 (accepting): anything more is too long
+        {3, 3}   // State 3: trap
+    };
+    Searcher searcher(Automaton(alphabet, transitions, {2}));
+
+    auto matches = searcher.FindAll("aababxab");
+    REQUIRE(matches.size() == 3);
+    REQUIRE(matches[0].start == 1);
+    REQUIRE(matches[0].end == 3);
+    REQUIRE(matches[1].start == 3);
+    REQUIRE(matches[1].end == 5);
+    REQUIRE(matches[2].start == 6);
+    REQUIRE(matches[2].end == 8);
+
+    REQUIRE_FALSE(searcher.Find("bbba").has_value());
+    REQUIRE_FALSE(searcher.Find("", 0).has_value());
+}
+
+TEST_CASE("Searcher uses leftmost-longest semantics", "[search]") {
+    SECTION("Longest extension of a run") {
+        // a b*
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+        vector<vector<int>> transitions = {{1, 2}, {2, 1}, {2, 2}};
+        Searcher searcher(Automaton(alphabet, transitions, {1}));
+
+        auto matches = searcher.FindAll("bbabbbab");
+        REQUIRE(matches.size() == 2);
+        REQUIRE(matches[0].start == 2);
+        REQUIRE(matches[0].end == 6);
+        REQUIRE(matches[1].start == 6);
+        REQUIRE(matches[1].end == 8);
+    }
+
+    SECTION("Leftmost match ends after an earlier, shorter one") {
+        // {"abc", "b"}: in "abc" the match "b" ends first but "abc" starts further left
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}, {'c', 2}};
+        vector<vector<int>> transitions = {
+            {1, 4, 5},  // State 0
+            {5, 2, 5},  // State 1: saw "a"
+            {5, 5, 3},  // State 2: saw "ab"
+            {5, 5, 5},  // State 3: saw "abc" (accepting)
+            {5, 5, 5},  // State 4: saw "b" (accepting)
+            {5, 5, 5}   // State 5: trap
+        };
+        Searcher searcher(Automaton(alphabet, transitions, {3, 4}));
+
+        auto match = searcher.Find("cabc");
+        REQUIRE(match.has_value());
+        REQUIRE(match->start == 1);
+        REQUIRE(match->end == 4);
+
+        // A candidate start that never completes falls back to the next one
+        match = searcher.Find("cabb");
+        REQUIRE(match.has_value());
+        REQUIRE(match->start == 2);
+        REQUIRE(match->end == 3);
+    }
+}
+
+TEST_CASE("Searcher edge cases", "[search][edge]") {
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+
+    SECTION("Bytes outside the alphabet break matches") {
+        // a+
+        Searcher searcher(Automaton(alphabet, {{1, 2}, {1, 2}, {2, 2}}, {1}));
+        auto matches = searcher.FindAll("aa-a\naaa");
+        REQUIRE(matches.size() == 3);
+        REQUIRE(matches[0].end == 2);
+        REQUIRE(matches[1].start == 3);
+        REQUIRE(matches[2].start == 5);
+        REQUIRE(matches[2].end == 8);
+    }
+
+    SECTION("Empty language never matches") {
+        Searcher searcher(Automaton(alphabet, {{0, 0}}, {}));
+        REQUIRE(searcher.FindAll("abab").empty());
+    }
+
+    SECTION("Language containing the empty word") {
+        // a*
+        Searcher searcher(Automaton(alphabet, {{0, 1}, {1, 1}}, {0}));
+        auto matches = searcher.FindAll("aab");
+        REQUIRE(matches.size() == 3);
+        REQUIRE(matches[0].start == 0);
+        REQUIRE(matches[0].end == 2);
+        REQUIRE(matches[1].start == 2);
+        REQUIRE(matches[1].end == 2);
+        REQUIRE(matches[2].start == 3);
+        REQUIRE(matches[2].end == 3);
+    }
+}
+
+TEST_CASE("Searcher agrees with trying every start", "[search]") {
+    std::mt19937 rng(26);
+    for (int trial = 0; trial < 200; trial++) {
+        Automaton dfa = RandomAutomaton(rng, 1 + trial % 12);
+        Searcher searcher(dfa);
+        string text = RandomText(rng, rng() % 60, "abcabcabc!");
+        for (size_t from = 0; from <= text.size(); from++) {
+            auto expected = BruteForceFind(dfa, text, from);
+            auto actual = searcher.Find(text, from);
+            CAPTURE(trial, text, from);
+            REQUIRE(actual.has_value() == expected.has_value());
+            if (expected) {
+                REQUIRE(actual->start == expected->start);
+                REQUIRE(actual->end == expected->end);
+            }
+        }
+    }
+}
+
+TEST_CASE("Failed candidate starts share one anchored scan", "[search]") {
+    // a* b a* c, or just "b": every 'a' before the 'b' is a candidate start that
+    // only fails at the end of the text. Scanning from each candidate in turn
+    // would take quadratic time here.
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}, {'c', 2}};
+    vector<vector<int>> transitions = {
+        {1, 2, 6},  // State 0
+        {1, 3, 6},  // State 1: a+
+        {4, 6, 5},  // State 2: "b" (accepting)
+        {4, 6, 5},  // State 3: a+ b
+        {4, 6, 5},  // State 4: a* b a+
+        {6, 6, 6},  // State 5: a* b a* c (accepting)
+        {6, 6, 6}   // State 6: trap
+    };
+    Searcher searcher(Automaton(alphabet, transitions, {2, 5}));
+
+    const size_t n = 200000;
+    string text = string(n, 'a') + "b" + string(n, 'a');
+    auto match = searcher.Find(text);
+    REQUIRE(match.has_value());
+    REQUIRE(match->start == n);
+    REQUIRE(match->end == n + 1);
+
+    match = searcher.Find(text + "c");
+    REQUIRE(match.has_value());
+    REQUIRE(match->start == 0);
+    REQUIRE(match->end == 2 * n + 2);
+}
@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+#include "state_map.h"
+#include "test_automata.h"
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+using std::string;
+
+namespace {
+
+// Reference: steps one row at a time the way Read does
+ScanResult Reference(const DfaTable& table, DfaTable::StateId row, const string& text)
+{
+    ScanResult result;
+    for (char c : text) {
+        if (row >= table.special_end) {
+            row = table.Step(row, static_cast<unsigned char>(c));
+        }
+        result.matches += table.IsAccepting(row);
+    }
+    result.row = row;
+    return result;
+}
+
+// The state after `text`, over the alphabet, walked on the transition matrix
+// without the table and its early exits
+int MatrixWalk(const Automaton& dfa, const string& text)
+{
+    int q = dfa.GetInitialState();
+    for (char c : text) {
+        q = dfa.GetTransitionMatrix()[static_cast<size_t>(q)][static_cast<size_t>(dfa.GetByteClasses().ColumnOf(c))];
+    }
+    return q;
+}
+
+} // namespace
+
+TEST_CASE("State maps", "[state_map]") {
+    std::mt19937 rng(44);
+
+    SECTION("Every start state maps like a direct read") {
+        for (int trial = 0; trial < 30; trial++) {
+            Automaton dfa = RandomAutomaton(rng, 1 + trial * 3, string("abcd", static_cast<size_t>(2 + trial % 3)));
+            const DfaTable& table = dfa.GetTable();
+            // A stray byte now and then sends some paths to the sentinel
+            string text = RandomText(rng, rng() % 2000, trial % 4 == 0 ? "abcd?" : "abcd");
+            StateMap map = ComputeStateMap(table, text, true);
+            StateMap plain = ComputeStateMap(table, text);
+            REQUIRE(plain.matches.empty());
+            for (size_t q = 0; q < map.to.size(); q++) {
+                DfaTable::StateId row = static_cast<DfaTable::StateId>(q) * table.stride;
+                ScanResult expected = Reference(table, row, text);
+                REQUIRE(map.Apply(row) == expected.row);
+                REQUIRE(plain.Apply(row) == expected.row);
+                REQUIRE(map.MatchesFrom(row) == expected.matches);
+            }
+        }
+    }
+
+    SECTION("Maps of consecutive pieces compose") {
+        Automaton dfa = RandomAutomaton(rng, 40, "abc");
+        const DfaTable& table = dfa.GetTable();
+        string text = RandomText(rng, 3000, "abc");
+        StateMap whole = ComputeStateMap(table, text, true);
+        StateMap pieces = StateMap::Identity(table, true);
+        for (size_t begin = 0; begin < text.size(); begin += 700) {
+            pieces = Compose(pieces, ComputeStateMap(table, text.substr(begin, 700), true));
+        }
+        REQUIRE(pieces.to == whole.to);
+        REQUIRE(pieces.matches == whole.matches);
+        REQUIRE(Compose(whole, ComputeStateMap(table, "", false)).matches.empty());
+    }
+
+    SECTION("Parallel scans agree with Read") {
+        for (int trial = 0; trial < 10; trial++) {
+            Automaton dfa = RandomAutomaton(rng, 5 + trial * 7, "abcd");
+            string text = RandomText(rng, 50000, trial % 3 == 0 ? "abcd!" : "abcd");
+            ScanResult scan = ScanParallel(dfa, text, 4096);
+            ScanResult expected = Reference(dfa.GetTable(), dfa.GetTable().start, text);
+            REQUIRE(scan.row == expected.row);
+            REQUIRE(scan.matches == expected.matches);
+            if (scan.row == DfaTable::kInvalidRow) {
+                REQUIRE_THROWS_AS(dfa.Read(text), std::invalid_argument);
+            } else {
+                REQUIRE(dfa.Read(text) == dfa.GetTable().IsAccepting(scan.row));
+            }
+        }
+    }
+
+    SECTION("Parallel scans end in the state of a plain matrix walk") {
+        // 1 and 2 only cycle through each other: an early exit there would stop at 1
+        Automaton cycle({{'a', 0}, {'b', 1}}, {{1, 0}, {2, 2}, {1, 1}}, {1, 2});
+        string text = RandomText(rng, 50000, "ab");
+        REQUIRE(cycle.GetTable().StateOf(ScanParallel(cycle, text, 4096).row) ==
+                static_cast<DfaTable::StateId>(MatrixWalk(cycle, text)));
+        REQUIRE(cycle.GetTable().StateOf(ScanParallel(cycle, "aa", 1).row) == 2);
+
+        for (int trial = 0; trial < 10; trial++) {
+            Automaton dfa = RandomAutomaton(rng, 5 + trial * 7, "abcd");
+            text = RandomText(rng, 20000, "abcd");
+            ScanResult scan = ScanParallel(dfa, text, 4096);
+            REQUIRE(dfa.GetTable().StateOf(scan.row) == static_cast<DfaTable::StateId>(MatrixWalk(dfa, text)));
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+#include "automaton.h"
+#include "table_memory.h"
+#include "test_automata.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::vector;
+using std::map;
+
+namespace {
+
+const std::string kLetters = "abcdefghijklmnopqrstuvwxyz";
+
+// Enough states that the transition table spans several huge pages; the
+// same seed gives the same automaton for every placement
+Automaton LargeAutomaton(TablePlacement placement)
+{
+    std::mt19937 rng(42);
+    return RandomAutomaton(rng, 40000, kLetters, placement);
+}
+
+} // namespace
+
+TEST_CASE("Huge page table memory", "[table_memory]") {
+    SECTION("Large mappings are huge-page aligned and writable") {
+        for (HugePages policy : {HugePages::Transparent, HugePages::Explicit}) {
+            size_t bytes = 3 * kHugePageSize + 100;
+            auto* p = static_cast<unsigned char*>(AllocateTableMemory(bytes, policy));
+            REQUIRE(reinterpret_cast<std::uintptr_t>(p) % kHugePageSize == 0);
+            p[0] = 1;
+            p[bytes - 1] = 2;
+            REQUIRE(p[0] + p[bytes - 1] == 3);
+            FreeTableMemory(p, bytes, policy);
+        }
+    }
+
+    SECTION("The policy follows copies of the table") {
+        vector<uint32_t, TableAllocator<uint32_t>> a(TableAllocator<uint32_t>(HugePages::Transparent));
+        a.assign(kHugePageSize, 7);
+        auto b = a;
+        REQUIRE(b.get_allocator().GetHugePages() == HugePages::Transparent);
+        REQUIRE(b == a);
+    }
+
+    SECTION("Every placement reads the same way") {
+        Automaton plain = LargeAutomaton(TablePlacement());
+        std::mt19937 rng(7);
+        vector<std::string> words(200);
+        for (auto& word : words) {
+            word = RandomText(rng, rng() % 300, kLetters);
+        }
+        for (HugePages policy : {HugePages::Transparent, HugePages::Explicit}) {
+            for (bool replicas : {false, true}) {
+                Automaton placed = LargeAutomaton({policy, replicas});
+                REQUIRE(placed.GetTable().next.get_allocator().GetHugePages() == policy);
+                REQUIRE(placed.GetTable().next == plain.GetTable().next);
+                for (const auto& word : words) {
+                    REQUIRE(placed.Read(word) == plain.Read(word));
+                }
+                REQUIRE_THROWS_AS(placed.Read("ab?"), std::invalid_argument);
+            }
+        }
+    }
+}
+
+TEST_CASE("NUMA topology", "[table_memory]") {
+    SECTION("CPU lists") {
+        REQUIRE(ParseCpuList("") == vector<int>{});
+        REQUIRE(ParseCpuList("3\n") == vector<int>{3});
+        REQUIRE(ParseCpuList("0-3,8,10-11") == vector<int>{0, 1, 2, 3, 8, 10, 11});
+        REQUIRE_THROWS_AS(ParseCpuList("3-1"), std::invalid_argument);
+        REQUIRE_THROWS_AS(ParseCpuList("a"), std::invalid_argument);
+        REQUIRE_THROWS_AS(ParseCpuList("1,-2"), std::invalid_argument);
+    }
+
+    SECTION("Every node has CPUs and the current CPU is on a node") {
+        NumaTopology topology = DetectNumaTopology();
+        REQUIRE(topology.NumNodes() >= 1);
+        for (size_t node = 0; node < topology.NumNodes(); node++) {
+            REQUIRE_FALSE(topology.cpus[node].empty());
+            for (int cpu : topology.cpus[node]) {
+                REQUIRE(topology.node_of_cpu[static_cast<size_t>(cpu)] == static_cast<int>(node));
+            }
+        }
+        REQUIRE(topology.CurrentNode() < topology.NumNodes());
+    }
+
+    SECTION("Work runs once per node, pinned to the node's CPUs") {
+        // Two fake nodes that share the first node's CPUs
+        NumaTopology real = DetectNumaTopology();
+        NumaTopology topology;
+        topology.cpus = {real.cpus[0], real.cpus[0]};
+        topology.node_of_cpu = real.node_of_cpu;
+        vector<int> cpu_of(2, -1);
+        RunOnEachNode(topology, [&](size_t node) {
+            cpu_of[node] = sched_getcpu();
+        });
+        for (int cpu : cpu_of) {
+            REQUIRE(real.node_of_cpu[static_cast<size_t>(cpu)] == 0);
+        }
+
+        REQUIRE_THROWS_AS(RunOnEachNode(topology, [](size_t node) {
+            if (node == 1) {
+                throw std::invalid_argument("node 1");
+            }
+        }), std::invalid_argument);
+    }
+}
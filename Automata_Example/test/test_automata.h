@@ -0,0 +1,64 @@
+#ifndef TEST_AUTOMATA_H
+#define TEST_AUTOMATA_H
+
+// Small automata and random inputs shared by the test executables. For random
+// automata with dead states and accepting sinks, and words that exercise the
+// caches, see GenerateAutomaton and GenerateWords in differential.h.
+
+#include "automaton.h"
+#include "multi_read.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Strings over {a, b} ending with 'b': 2^(n-1) words of length n >= 1
+inline Automaton EndsWithB()
+{
+    return Automaton({{'a', 0}, {'b', 1}}, {{0, 1}, {0, 1}}, {1});
+}
+
+// Uniformly random transitions over `symbols`, symbols[k] in column k, with
+// about a third of the states accepting
+inline Automaton RandomAutomaton(std::mt19937& rng, int num_states, const std::string& symbols = "abc",
+                                 TablePlacement placement = TablePlacement())
+{
+    std::map<char, int> alphabet;
+    for (size_t k = 0; k < symbols.size(); k++) {
+        alphabet[symbols[k]] = static_cast<int>(k);
+    }
+    std::uniform_int_distribution<int> state(0, num_states - 1);
+    std::vector<std::vector<int>> M(static_cast<size_t>(num_states), std::vector<int>(symbols.size()));
+    std::vector<int> accepting;
+    for (int q = 0; q < num_states; q++) {
+        for (auto& target : M[static_cast<size_t>(q)]) {
+            target = state(rng);
+        }
+        if (rng() % 3 == 0) {
+            accepting.push_back(q);
+        }
+    }
+    return Automaton(alphabet, M, accepting, Validation::Full, placement);
+}
+
+inline std::string RandomText(std::mt19937& rng, size_t length, const std::string& symbols)
+{
+    std::string text(length, ' ');
+    for (auto& c : text) {
+        c = symbols[rng() % symbols.size()];
+    }
+    return text;
+}
+
+// What Read says about `word` from the initial state
+inline ReadResult ExpectedResult(Automaton dfa, const std::string& word)
+{
+    try {
+        return dfa.Read(word) ? ReadResult::Accepted : ReadResult::Rejected;
+    } catch (const std::invalid_argument&) {
+        return ReadResult::InvalidSymbol;
+    }
+}
+
+#endif // TEST_AUTOMATA_H
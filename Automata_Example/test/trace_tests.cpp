@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+#include "trace.h"
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+#include <map>
+
+using std::vector;
+using std::map;
+
+namespace {
+
+// Counts 'a's modulo 3
+Automaton CountAsModThree()
+{
+    map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+    vector<vector<int>> transitions = {{1, 0}, {2, 1}, {0, 2}};
+    return Automaton(alphabet, transitions, {0});
+}
+
+} // namespace
+
+TEST_CASE("Trace into a caller-provided buffer", "[trace]") {
+    Automaton dfa = CountAsModThree();
+
+    uint32_t states[8];
+    REQUIRE(TraceStates(dfa, "abaa", states, 8) == 5);
+    REQUIRE(vector<uint32_t>(states, states + 5) == vector<uint32_t>{0, 1, 1, 2, 0});
+
+    SECTION("Short buffer reports the full length") {
+        uint32_t few[2];
+        REQUIRE(TraceStates(dfa, "abaa", few, 2) == 5);
+        REQUIRE(few[1] == 1);
+    }
+
+    SECTION("Path continues through absorbing states") {
+        map<char, int> alphabet = {{'a', 0}, {'b', 1}};
+        Automaton sink(alphabet, {{1, 0}, {2, 2}, {1, 1}}, {1, 2});
+        REQUIRE(TraceStates(sink, "aaa", states, 8) == 4);
+        REQUIRE(vector<uint32_t>(states, states + 4) == vector<uint32_t>{0, 1, 2, 1});
+    }
+
+    SECTION("Invalid symbols throw") {
+        REQUIRE_THROWS_AS(TraceStates(dfa, "abc", states, 8), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Delta-encoded trace log", "[trace]") {
+    TraceLog log;
+    vector<uint32_t> path = {0, 1, 1, 300, 2, 70000, 0, UINT32_MAX, 5};
+    for (uint32_t s : path) {
+        log.Append(s);
+    }
+    REQUIRE(log.Size() == path.size());
+    REQUIRE(log.Decode() == path);
+
+    TraceLog copy = TraceLog::FromBytes(log.Bytes());
+    REQUIRE(copy.Decode() == path);
+    copy.Append(6);
+    REQUIRE(copy.Decode().back() == 6);
+
+    REQUIRE_THROWS_AS(TraceLog::FromBytes({0x80}), std::invalid_argument);
+}
+
+TEST_CASE("Trace files report I/O errors", "[trace]") {
+    TraceLog log;
+    log.Append(1);
+    // /dev/full accepts the open and the buffered write, then fails the flush in fclose
+    if (std::FILE* probe = std::fopen("/dev/full", "wb")) {
+        std::fclose(probe);
+        REQUIRE_THROWS_AS(log.WriteFile("/dev/full"), std::runtime_error);
+    }
+    // A directory opens for reading, but every read fails rather than hitting end of file
+    if (std::FILE* probe = std::fopen(".", "rb")) {
+        std::fclose(probe);
+        REQUIRE_THROWS_AS(TraceLog::ReadFile("."), std::runtime_error);
+    }
+    REQUIRE_THROWS_AS(TraceLog::ReadFile("/nonexistent/dir/trace.bin"), std::runtime_error);
+}
+
+TEST_CASE("Replay against a recorded trace", "[trace]") {
+    Automaton dfa = CountAsModThree();
+    TraceLog recorded = RecordTrace(dfa, "aab");
+    REQUIRE(recorded.Decode() == vector<uint32_t>{0, 1, 2, 2});
+
+    REQUIRE(ReplayTrace(dfa, "aab", recorded).identical);
+
+    TraceDiff diff = ReplayTrace(dfa, "abb", recorded);
+    REQUIRE_FALSE(diff.identical);
+    REQUIRE(diff.position == 2);
+    REQUIRE(diff.expected == 2);
+    REQUIRE(diff.actual == 1);
+
+    diff = ReplayTrace(dfa, "aabaa", recorded);
+    REQUIRE(diff.position == 4);
+    REQUIRE(diff.expected == TraceDiff::kNoState);
+
+    diff = ReplayTrace(dfa, "a", recorded);
+    REQUIRE(diff.position == 2);
+    REQUIRE(diff.actual == TraceDiff::kNoState);
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+#include "transducer.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+using std::vector;
+using std::map;
+using Output = Transducer::Output;
+
+namespace {
+
+const map<char, int> kFields = {{'a', 0}, {'b', 1}, {',', 2}};
+
+// Tags each symbol with the index of the comma-separated field it belongs to,
+// saturating at field 2. State k is "inside field k"; state 2 is an accepting sink.
+Transducer FieldTagger()
+{
+    return Transducer(kFields,
+                      {{0, 0, 1}, {1, 1, 2}, {2, 2, 2}},
+                      {0, 1, 2},
+                      {{0, 0, 0}, {1, 1, 1}, {2, 2, 2}});
+}
+
+} // namespace
+
+TEST_CASE("Transducer outputs", "[transducer]") {
+    Transducer tagger = FieldTagger();
+
+    SECTION("One output per symbol, including after an absorbing state") {
+        std::string word = "ab,b,,a";
+        vector<Output> out(word.size());
+        REQUIRE(tagger.Read(word, out.data()));
+        REQUIRE(out == vector<Output>{0, 0, 0, 1, 1, 2, 2});
+        REQUIRE(tagger.GetAutomaton().IsAcceptingSink(2));
+    }
+
+    SECTION("Reading can continue from the current state") {
+        vector<Output> out(3);
+        tagger.Read("a,", out.data());
+        tagger.Read("b", out.data() + 2, false);
+        REQUIRE(out == vector<Output>{0, 0, 1});
+    }
+
+    SECTION("Invalid symbols") {
+        vector<Output> out(4, 99);
+        REQUIRE_THROWS_AS(tagger.Read("a,x,", out.data()), std::invalid_argument);
+        REQUIRE(out == vector<Output>{0, 0, 99, 99});
+
+        // The state is the one before the invalid symbol
+        tagger.Read(",", out.data(), false);
+        REQUIRE(out[0] == 1);
+    }
+
+    SECTION("Output lookup") {
+        REQUIRE(tagger.GetOutput(1, ',') == 1);
+        REQUIRE_THROWS_AS(tagger.GetOutput(3, 'a'), std::invalid_argument);
+        REQUIRE_THROWS_AS(tagger.GetOutput(0, 'x'), std::invalid_argument);
+    }
+
+    SECTION("Output matrix must match the transition matrix") {
+        REQUIRE_THROWS_AS(Transducer(kFields, {{0, 0, 0}}, {0}, {}), std::invalid_argument);
+        REQUIRE_THROWS_AS(Transducer(kFields, {{0, 0, 0}}, {0}, {{1, 2}}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Transducer agrees with the matrices", "[transducer]") {
+    std::mt19937 rng(37);
+    const map<char, int> alphabet = {{'a', 0}, {'b', 1}, {'c', 2}};
+    for (int trial = 0; trial < 20; trial++) {
+        int n = 1 + trial % 8;
+        std::uniform_int_distribution<int> pick_state(0, n - 1);
+        vector<vector<int>> M(static_cast<size_t>(n), vector<int>(3));
+        vector<vector<Output>> O(static_cast<size_t>(n), vector<Output>(3));
+        vector<int> accepting;
+        for (size_t q = 0; q < M.size(); q++) {
+            for (size_t c = 0; c < 3; c++) {
+                M[q][c] = pick_state(rng);
+                O[q][c] = rng() % 1000;
+            }
+            if (rng() % 2 == 0) {
+                accepting.push_back(static_cast<int>(q));
+            }
+        }
+        Transducer machine(alphabet, M, accepting, O);
+        Automaton dfa(alphabet, M, accepting);
+
+        std::string word;
+        for (int i = 0; i < 50; i++) {
+            word += static_cast<char>('a' + rng() % 3);
+        }
+        vector<Output> out(word.size());
+        REQUIRE(machine.Read(word, out.data()) == dfa.Read(word));
+
+        size_t q = 0;
+        for (size_t i = 0; i < word.size(); i++) {
+            size_t c = static_cast<size_t>(word[i] - 'a');
+            REQUIRE(out[i] == O[q][c]);
+            q = static_cast<size_t>(M[q][c]);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+#include "utf8_alphabet.h"
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <string>
+
+using std::vector;
+using std::string;
+
+namespace {
+
+enum Column { Latin, Greek, Cjk, Emoji };
+
+const vector<Utf8Symbol> kScripts = {
+    {U'a', U'z', Latin},
+    {U'α', U'ω', Greek},
+    {0x4E00, 0x9FFF, Cjk},
+    {0x1F600, 0x1F64F, Emoji},
+};
+
+// Words whose last character is a CJK ideograph; state i remembers the last column
+Automaton EndsWithCjk()
+{
+    vector<int> to = {0, 1, 2, 3};
+    return CompileUtf8Automaton(kScripts, {to, to, to, to}, {Cjk});
+}
+
+// Rejects instead of throwing when Read meets an invalid byte
+bool Accepts(Automaton& dfa, const string& text)
+{
+    try {
+        return dfa.Read(text);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+} // namespace
+
+TEST_CASE("UTF-8 alphabets", "[utf8]") {
+    Automaton dfa = EndsWithCjk();
+
+    SECTION("Code points of every encoding length") {
+        REQUIRE(dfa.Read("abc中"));
+        REQUIRE(dfa.Read("αβ😀字"));
+        REQUIRE_FALSE(dfa.Read("中a"));
+        REQUIRE_FALSE(dfa.Read("中😀"));
+        REQUIRE_FALSE(dfa.Read(""));
+    }
+
+    SECTION("Malformed or foreign input is rejected") {
+        REQUIRE_FALSE(Accepts(dfa, "中\xE4\xB8"));          // truncated
+        REQUIRE_FALSE(Accepts(dfa, "\xC1\xA1中"));          // overlong 'a'
+        REQUIRE_FALSE(Accepts(dfa, "\xED\xA0\x80中"));      // surrogate
+        REQUIRE_FALSE(Accepts(dfa, "中€"));                 // not in the alphabet
+        REQUIRE_THROWS_AS(dfa.Read("A中"), std::invalid_argument);
+    }
+
+    SECTION("Continuation chains are shared") {
+        // 4 states + dead + a handful of intermediate states, not one per code point
+        REQUIRE(dfa.GetNumStates() < 20);
+    }
+}
+
+TEST_CASE("UTF-8 ranges match exactly their code points", "[utf8]") {
+    // Ranges chosen to straddle encoding-length and continuation-byte boundaries
+    const vector<Utf8Symbol> alphabet = {
+        {0x41, 0x7F, 0}, {0x80, 0x80, 1}, {0x7FE, 0x801, 0}, {0xD700, 0xE0FF, 0},
+        {0xFFC0, 0x1003F, 1}, {0x10FFF0, 0x10FFFF, 0}, {0x3A5, 0x3A5, 0},
+    };
+    Automaton single = CompileUtf8Automaton(alphabet, {{1, 2}, {2, 2}, {2, 2}}, {1});
+
+    auto in_column_zero = [&](char32_t cp) {
+        for (const auto& symbol : alphabet) {
+            if (cp >= symbol.first && cp <= symbol.last) {
+                return symbol.column == 0;
+            }
+        }
+        return false;
+    };
+    // Everything near a range end or an encoding boundary, and a sparse sweep of the rest
+    vector<char32_t> probes;
+    for (char32_t edge : {0x7Fu, 0x7FFu, 0xFFFFu, 0xD7FFu, 0xE000u, 0x10FFFFu}) {
+        probes.push_back(edge);
+    }
+    for (const auto& symbol : alphabet) {
+        probes.push_back(symbol.first);
+        probes.push_back(symbol.last);
+    }
+    for (size_t i = 0, n = probes.size(); i < n; i++) {
+        for (char32_t d = 1; d <= 70; d++) {
+            probes.push_back(probes[i] - d);
+            probes.push_back(probes[i] + d);
+        }
+    }
+    for (char32_t cp = 0; cp <= 0x10FFFF; cp += 61) {
+        probes.push_back(cp);
+    }
+    for (char32_t cp : probes) {
+        if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            continue;
+        }
+        if (Accepts(single, EncodeUtf8(cp)) != in_column_zero(cp)) {
+            FAIL("Mismatch at code point " << static_cast<unsigned>(cp));
+        }
+    }
+    REQUIRE_FALSE(Accepts(single, EncodeUtf8(0x41) + EncodeUtf8(0x41)));
+}
+
+TEST_CASE("UTF-8 bytes with identical transitions share a column", "[utf8]") {
+    // ASCII text and any non-ASCII code point; state i counts non-ASCII characters up to 9
+    const vector<Utf8Symbol> alphabet = {{0x20, 0x7E, 0}, {0x80, 0x10FFFF, 1}};
+    vector<vector<int>> M(10);
+    for (int q = 0; q < 10; q++) {
+        M[static_cast<size_t>(q)] = {q, std::min(q + 1, 9)};
+    }
+    Automaton dfa = CompileUtf8Automaton(alphabet, M, {2});
+
+    // Printable ASCII is one column; the lead and continuation bytes fall
+    // into a few ranges with the same targets, not one column per byte
+    REQUIRE(dfa.GetNumColumns() <= 12);
+    REQUIRE(dfa.Read("aé b中"));
+    REQUIRE_FALSE(dfa.Read("😀"));
+    REQUIRE_FALSE(Accepts(dfa, "\xC0\x80\xC3\xA9"));
+}
+
+TEST_CASE("UTF-8 alphabet validation", "[utf8]") {
+    vector<vector<int>> M = {{0, 0}};
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x10, 0x20, 0}, {0x20, 0x30, 1}}, M, {0}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x30, 0x20, 0}}, M, {0}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x10, 0x110000, 0}}, M, {0}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x10, 0x20, 2}}, M, {0}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x10, 0x20, 0}}, {{0, 1}}, {0}), std::invalid_argument);
+    REQUIRE_THROWS_AS(CompileUtf8Automaton({{0x10, 0x20, 0}}, M, {1}), std::invalid_argument);
+    REQUIRE_THROWS_AS(EncodeUtf8(0xD800), std::invalid_argument);
+}